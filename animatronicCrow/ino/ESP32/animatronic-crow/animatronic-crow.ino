@@ -8,6 +8,7 @@
  * - Synchronized beak animations with audio files
  * - Non-blocking control
  * - Random eye blinking
+ * - Low-power idle: neck coils released and the loop sleeps between events
  * - Test mode for sensor debugging
  * - LD1020 mode enables animation cooldown to prevent self-triggering
  * - BUTTON mode for "Try Me" functionality
@@ -28,7 +29,9 @@
 
 #include "settings.h"
 #include "animations.h"
+#include "calibration.h"
 #include "crow-utils.h"
+#include "power.h"
 
 // ============================================================================
 // GLOBAL OBJECTS 
@@ -108,11 +111,13 @@ void setup() {
   initializeNeopixel();
   showPixel(0, 50, 0); // NeoPixel: green
 
+  initializeCalibration();
   initializeEyes();
   initializeBeak();
   initializeNeck();
   initializeDFPlayer();
   initializeMotionSensor();
+  powerBegin(SENSOR_MODE != SENSOR_MODE_NONE);
 
   resetIdleTimers();
 
@@ -124,11 +129,18 @@ void setup() {
 // MAIN LOOP - CORE 0
 // ============================================================================
 void loop() {
+  // Sleep until the next scheduled event while the crow is at rest
+  idleSleep(millis());
+
   unsigned long now = millis();
   stepper.run();
   updateBeak();
   updateSensorState(now);
 
+  // Release the neck coils once settled
+  powerUpdate(now, stepper.distanceToGo() == 0);
+  powerReport(now);
+
   // BUTTON MODE: Handle button sequence
   if (SENSOR_MODE == SENSOR_MODE_BUTTON) {
     // Handle blinking in test mode or during sequence
@@ -231,6 +243,33 @@ void loop() {
 // INITIALIZATION FUNCTIONS
 // ============================================================================
 
+void initializeCalibration() {
+  switch (loadCalibration()) {
+    case CAL_LOADED:
+      Serial.println(F("[Init]   Calibration loaded from flash"));
+      break;
+    case CAL_REBUILT:
+      Serial.println(F("[Init]   Calibration loaded from flash (easing table rebuilt)"));
+      break;
+    case CAL_EMPTY:
+      Serial.println(F("[Init]   No stored calibration, using settings.h"));
+      break;
+    case CAL_UNSUPPORTED:
+      Serial.println(F("[Init]   ✗ Stored calibration is from a newer version, using settings.h"));
+      break;
+    case CAL_CORRUPT:
+      Serial.println(F("[Init]   ✗ Stored calibration is corrupt, using settings.h"));
+      break;
+  }
+  if (crowCal.lagBaseMs > 0 || crowCal.lagTravelMs > 0) {
+    Serial.print(F("[Init]   Beak lead: "));
+    Serial.print(crowCal.lagBaseMs);
+    Serial.print(F("ms + "));
+    Serial.print(crowCal.lagTravelMs);
+    Serial.println(F("ms per full move"));
+  }
+}
+
 void initializeEyes() {
   pinMode(PIN_LED_EYES, OUTPUT);
   digitalWrite(PIN_LED_EYES, HIGH);
@@ -245,20 +284,20 @@ void initializeEyes() {
 
 void initializeBeak() {
   showPixel(25, 25, 25); // NeoPixel: white
-  int mid = (SERVO_PWM_OPEN + SERVO_PWM_CLOSED) / 2;
+  int mid = (crowCal.pwmOpen + crowCal.pwmClosed) / 2;
   beakServo.writeMicroseconds(mid);  // start center
-  beakServo.attach(PIN_SERVO, SERVO_PWM_OPEN, SERVO_PWM_CLOSED);
+  beakServo.attach(PIN_SERVO, crowCal.pwmOpen, crowCal.pwmClosed);
   beakServo.setTimerWidth(16);
   delay(200);
-  for (int p = mid; p > SERVO_PWM_OPEN; p--) {  // move open
+  for (int p = mid; p > crowCal.pwmOpen; p--) {  // move open
     beakServo.writeMicroseconds(p);
     delay(2);
   }
-  for (int p = SERVO_PWM_OPEN; p < SERVO_PWM_CLOSED; p++) {  // move closed
+  for (int p = crowCal.pwmOpen; p < crowCal.pwmClosed; p++) {  // move closed
     beakServo.writeMicroseconds(p);
     delay(2);
   }
-  beakServo.writeMicroseconds(SERVO_PWM_CLOSED);
+  beakServo.writeMicroseconds(crowCal.pwmClosed);
   delay(200);
   Serial.println(F("[Init]   Beak servo online"));
   delay(500);
@@ -301,7 +340,7 @@ void initializeDFPlayer() {
     showPixel(50, 0, 50); // NeoPixel: purple
 
     delay(2000);
-    dfPlayer.volume(DFPLAYER_VOLUME);
+    dfPlayer.volume(crowCal.volume);
     delay(200);
     dfPlayer.play(11);
   }
@@ -441,7 +480,7 @@ void executeButtonSequence(unsigned long now) {
       case 7:
         Serial.println(F("[Button] Centering Neck"));
         setNeckSpeedSlow();
-        stepper.moveTo(NECK_CENTER);
+        moveNeckTo(NECK_CENTER);
         buttonStep++;
       case 8:
         if (stepper.distanceToGo() == 0) {
@@ -471,7 +510,7 @@ void handleIdleMode(unsigned long now, bool squawkEnabled, bool ld1020Clear) {
       }
     }
     // Trigger idle movement and (re)set volume
-    dfPlayer.volume(DFPLAYER_VOLUME);
+    dfPlayer.volume(crowCal.volume);
     startIdleMove(now);
   }
 
@@ -492,7 +531,7 @@ void startScoldSequence() {
   int rangePercent = random(0, NECK_RANGE_SCOLD_PERCENT + 1);
   int direction = random(0, 2) == 0 ? 1 : -1;
   int scoldPos = (NECK_SIDE * rangePercent / 100) * direction;
-  stepper.moveTo(scoldPos);
+  moveNeckTo(scoldPos);
 
   Serial.print(F("[Scold]  Turning head to "));
   Serial.println(scoldPos);
@@ -519,7 +558,7 @@ void startIdleMove(unsigned long now) {
   int direction = random(0, 2) == 0 ? 1 : -1;  // Left or right
   int targetPos = (NECK_SIDE * rangePercent / 100) * direction;
 
-  stepper.moveTo(targetPos);
+  moveNeckTo(targetPos);
 
   Serial.print(F("[Idle]   Moving neck to "));
   Serial.print(targetPos);
@@ -549,6 +588,28 @@ void addBlockToSquawkTime() {
   nextIdleSquawkTime = millis() + SCOLD_SQUAWK_BLOCK_MS;
 }
 
+// ============================================================================
+// LOW-POWER IDLE
+// ============================================================================
+
+void idleSleep(unsigned long now) {
+  // Only sleep when nothing is moving or about to move
+  if (stepper.distanceToGo() != 0 || animating || pendingAnimation != nullptr) return;
+  if (SENSOR_MODE == SENSOR_MODE_BUTTON) {
+    if (buttonTriggered || buttonSequenceActive) return;
+    powerSleepUntil(now, now + POWER_MAX_SLEEP_MS);
+    return;
+  }
+  if (currentMode != MODE_IDLE || sensorCurrentlyHigh) return;
+
+  PowerSchedule schedule = {
+    nextBlinkTime, nextIdleSquawkTime, nextIdleMoveTime, lastAudioTime, max(movementEnd, movementStart),
+    SENSOR_MODE == SENSOR_MODE_LD1020, !TEST_MODE
+  };
+  unsigned long deadline = powerIdleDeadline(now, schedule);
+  powerSleepUntil(now, deadline);
+}
+
 // ============================================================================
 // SENSOR MONITOR
 // ============================================================================
@@ -587,19 +648,24 @@ void updateSensorState(unsigned long now) {
 // ============================================================================
 
 void setNeckSpeedSlow() {
-  stepper.setMaxSpeed(NECK_SPEED_SLOW_MAX);
-  stepper.setAcceleration(NECK_SPEED_SLOW_ACCEL);
+  stepper.setMaxSpeed(crowCal.neckSlowMax);
+  stepper.setAcceleration(crowCal.neckSlowAccel);
 }
 
 void setNeckSpeedFast() {
-  stepper.setMaxSpeed(NECK_SPEED_FAST_MAX);
-  stepper.setAcceleration(NECK_SPEED_FAST_ACCEL);
+  stepper.setMaxSpeed(crowCal.neckFastMax);
+  stepper.setAcceleration(crowCal.neckFastAccel);
+}
+
+void moveNeckTo(long position) {
+  powerWakeNeck();
+  stepper.moveTo(position);
 }
 
 void resetNeckToCenter() {
   stepper.stop();
   setNeckSpeedFast();
-  stepper.moveTo(NECK_CENTER);
+  moveNeckTo(NECK_CENTER);
 
   // Wait for completion
   while (stepper.distanceToGo() != 0) {
@@ -623,7 +689,7 @@ void animateAudio(uint8_t trackNum) {
     dfPlayer.play(trackNum);
 
     // queue animation with delay to get DFPlayer started
-    queuePendingAnimation(idx, millis() + AUDIO_SYNC_DELAY_MS);
+    queuePendingAnimation(idx, millis() + crowCal.audioSyncDelayMs);
   } else {
     Serial.println(F("✗ Audio  Track index out of bounds!"));
   }
@@ -635,18 +701,18 @@ void animateAudio(uint8_t trackNum) {
 
 void handleBlinking(unsigned long now) {
   static bool eyesOpen = true;
-  static unsigned long blinkStartTime = 0;
 
+  // nextBlinkTime is the next eye change (close or reopen)
   if (eyesOpen) {
     // Check if it's time to blink
     if (now >= nextBlinkTime) {
       digitalWrite(PIN_LED_EYES, LOW);
       eyesOpen = false;
-      blinkStartTime = now;
+      nextBlinkTime = now + BLINK_DURATION_MS;
     }
   } else {
     // Check if blink is complete
-    if (now - blinkStartTime >= BLINK_DURATION_MS) {
+    if (now >= nextBlinkTime) {
       digitalWrite(PIN_LED_EYES, HIGH);
       eyesOpen = true;
       nextBlinkTime = now + random(BLINK_MIN_INTERVAL_MS, BLINK_MAX_INTERVAL_MS);
@@ -11,7 +11,7 @@
 extern Servo beakServo;
 extern DFRobotDFPlayerMini dfPlayer;
 
-static uint8_t lastSentPWM = -1;
+static int lastSentPWM = -1;
 
 /**
  * Handles the logic updating servo position
@@ -30,6 +30,8 @@
 #define SERVO_PWM_OPEN                1050  // fully open PWM
 #define SERVO_PWM_CLOSED              1250  // fully closed PWM
 #define SERVO_EASING_FACTOR           3.00  // determines animation smooting (smaller is smoother)
+#define SERVO_LAG_BASE_MS             0     // beak lag behind any move, ms (measure with calibrate-crow)
+#define SERVO_LAG_TRAVEL_MS           0     // added lag for a full open-close move, ms
 
 // Audio Settings
 #define DFPLAYER_VOLUME               25  	// Volume 0-30
@@ -62,4 +64,12 @@
 #define NECK_SPEED_FAST_ACCEL         4000  // Fast movement acceleration
 #define NECK_RANGE_SCOLD_PERCENT        20  // Percent of range to move during scold (+/-)
 
+// Power Settings
+#define POWER_RELEASE_COILS           true  // De-energize the neck stepper once it has settled
+#define POWER_COIL_RELEASE_MS         500   // How long the neck must be still before releasing
+#define POWER_IDLE_SLEEP              true  // Sleep between scheduled events (motion sensor wakes the crow)
+#define POWER_MIN_SLEEP_MS            2     // Skip sleeps shorter than this
+#define POWER_MAX_SLEEP_MS            1000  // Longest single sleep
+#define POWER_REPORT_MS               60000 // Log power counters to Serial (0 to disable)
+
 #endif
\ No newline at end of file
@@ -32,7 +32,7 @@ const AnimKeyFrame anim_Idle5[]  PROGMEM = {{0,0},{210,80},{350,40},{700,80},{87
 const AnimKeyFrame anim_Idle6[]  PROGMEM = {{0,0},{137,70},{200,40},{500,10},{700,90},{840,45},{1000,0}};
 const AnimKeyFrame anim_Idle7[]  PROGMEM = {{0,0},{350,10},{425,70},{700,30},{1280,35},{1380,70},{1690,30},{2970,35},{3070,70},{3400,30},{4240,35},{4340,65},{4610,60},{4710,30},{4780,0}};
 
-const SoundAnimation soundAnimations[] PROGMEM = {
+constexpr SoundAnimation soundAnimations[] PROGMEM = {
   {1,  anim_Scold1, sizeof(anim_Scold1) / sizeof(AnimKeyFrame)},
   {2,  anim_Scold2, sizeof(anim_Scold2) / sizeof(AnimKeyFrame)},
   {3,  anim_Scold3, sizeof(anim_Scold3) / sizeof(AnimKeyFrame)},
@@ -68,6 +68,22 @@ static unsigned long pendingAnimationStartTime = 0;
 // Easing Lookup Table
 static uint16_t easingLUT[101];
 
+// Servo Lag Model: the beak arrives lagBase + lagTravel * travel/100 ms after
+// a move of travel (0-100%) is commanded, so keyframes are led by that much
+static uint16_t lagBaseMs = SERVO_LAG_BASE_MS;
+static uint16_t lagTravelMs = SERVO_LAG_TRAVEL_MS;
+
+void setServoLag(uint16_t baseMs, uint16_t travelMs) {
+  lagBaseMs = baseMs;
+  lagTravelMs = travelMs;
+}
+
+// provides the lag for a move of travel (0-100%); holds have none
+inline uint16_t servoLagMs(uint8_t travel) {
+  if (travel == 0) return 0;
+  return lagBaseMs + (uint32_t)lagTravelMs * travel / 100;
+}
+
 void hydrateEasingLUT(int openLimit, int closedLimit, float p) {
   for (int i = 0; i <= 100; i++) {
     float x = (float)i / 100.0;
@@ -84,20 +100,30 @@ inline void queuePendingAnimation(int idx, unsigned long startTime) {
     pendingAnimationStartTime = startTime;
 }
 
+// provides keyframe idx's time led by the lag of the move into it
+// (never before the previous keyframe, so segments stay in order)
+inline uint16_t getLeadKeyframeTime(uint8_t idx) {
+  uint16_t t = pgm_read_word(&(currentAnimation[idx].timeMs));
+  if (idx == 0) return t;
+  uint16_t tPrev = pgm_read_word(&(currentAnimation[idx - 1].timeMs));
+  uint8_t p = pgm_read_byte(&(currentAnimation[idx].position));
+  uint8_t pPrev = pgm_read_byte(&(currentAnimation[idx - 1].position));
+  uint16_t lead = servoLagMs(p > pPrev ? p - pPrev : pPrev - p);
+  return (t - tPrev > lead) ? t - lead : tPrev;
+}
+
 inline void updateKeyframeCache() {
-  cached_t0 = pgm_read_word(&(currentAnimation[currentKeyframe].timeMs));
+  cached_t0 = getLeadKeyframeTime(currentKeyframe);
   cached_p0 = pgm_read_byte(&(currentAnimation[currentKeyframe].position));
-  cached_t1 = pgm_read_word(&(currentAnimation[currentKeyframe + 1].timeMs));
+  cached_t1 = getLeadKeyframeTime(currentKeyframe + 1);
   cached_p1 = pgm_read_byte(&(currentAnimation[currentKeyframe + 1].position));
 }
 
-// provides the current 0-100% closed-open position for the animation
+// provides the 0-100% closed-open position for the animation at time now
 // or -1 if the animation is not active
-inline int getAnimPos() {
+inline int getAnimPosAt(unsigned long now) {
   if (easingLUT[100] == 0) hydrateEasingLUT(SERVO_PWM_OPEN, SERVO_PWM_CLOSED, SERVO_EASING_FACTOR);
 
-  unsigned long now = millis();
-
   if (pendingAnimation != nullptr) {
     if (now >= pendingAnimationStartTime) { // enable after sync delay
       currentAnimation = pendingAnimation;
@@ -124,8 +150,7 @@ inline int getAnimPos() {
   unsigned long elapsed = now - animationStartTime;
 
   while (currentKeyframe < totalKeyframes - 2) {
-    uint16_t nextTime = pgm_read_word(&(currentAnimation[currentKeyframe + 1].timeMs));
-    if (elapsed >= nextTime) {
+    if (elapsed >= cached_t1) {
       currentKeyframe++;
       updateKeyframeCache();
     }
@@ -138,13 +163,21 @@ inline int getAnimPos() {
   return cached_p0 + (int)((cached_p1 - cached_p0) * (float)elapsedInSegment / segmentDuration);
 }
 
-// provides the current, eased PWM position-in-range for the animation
+inline int getAnimPos() {
+  return getAnimPosAt(millis());
+}
+
+// provides the eased PWM position-in-range for the animation at time now
 // or -1 if the animation is not active
-inline int getEasedAnimPWM() {
-  int p = getAnimPos();
+inline int getEasedAnimPWMAt(unsigned long now) {
+  int p = getAnimPosAt(now);
   if (p == -1) return -1;
   p = constrain(p, 0, 100);
   return easingLUT[p];
 }
 
+inline int getEasedAnimPWM() {
+  return getEasedAnimPWMAt(millis());
+}
+
 #endif
\ No newline at end of file
@@ -13,7 +13,7 @@ extern DFRobotDFPlayerMini dfPlayer;
 extern unsigned int beakOpen;
 extern unsigned int beakClosed;
 
-static uint8_t lastSentPWM = -1;
+static int lastSentPWM = -1;
 
 /**
  * Handles the logic of attaching/detaching the servo and updating 
@@ -17,11 +17,14 @@
 #define PIN_LED_EYES                  6    // LED1
 #define PIN_MOTION_SENSOR             5    // SNSR1
 #define PIN_NEOPIXEL_POWER            21
+#define PIN_SERVO_FEEDBACK            -1    // ADC pin on a feedback servo's pot, e.g. 4 (-1: none)
 
 // Servo Settings
 #define SERVO_PWM_OPEN                1100 // default fully open PWM
 #define SERVO_PWM_CLOSED              1250 // default fully closed PWM
 #define SERVO_EASING_FACTOR           3.00 // determines animation smooting (smaller is smoother)
+#define SERVO_LAG_BASE_MS             0    // beak lag behind any move, ms (measure with calibrate-crow)
+#define SERVO_LAG_TRAVEL_MS           0    // added lag for a full open-close move, ms
 #define SERVO_PWM_MIN                 1000 // min for calibration
 #define SERVO_PWM_MAX                 1500 // max for calibration
 
@@ -31,5 +34,9 @@
 
 // Neck Movement Settings
 #define NECK_RANGE                    1400  // Total range of motion
+#define NECK_SPEED_SLOW_MAX           3250  // Slow movement max speed
+#define NECK_SPEED_SLOW_ACCEL         500   // Slow movement acceleration
+#define NECK_SPEED_FAST_MAX           6000  // Fast movement max speed
+#define NECK_SPEED_FAST_ACCEL         4000  // Fast movement acceleration
 
 #endif
\ No newline at end of file
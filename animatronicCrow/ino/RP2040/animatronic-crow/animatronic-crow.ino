@@ -3,14 +3,22 @@
  * ---------------------------
  *
  * Features:
- * - Dual-core: Core1 monitors motion sensor, Core0 runs animations
+ * - Dual-core: Core1 runs sensors, behaviors and audio, Core0 drives the neck
+ *   and beak (CORE_SPLIT); or Core1 only monitors the sensor
  * - Scolding, idle movements, random squawks
  * - Synchronized beak animations with audio files
  * - Non-blocking control
  * - Random eye blinking
+ * - Low-power idle: neck coils released and both cores sleep between events
  * - Test mode for sensor debugging
+ * - Session recorder, replayed on a PC by crow-host/crow-replay
+ * - Health monitor: heartbeats, stuck-mode recovery, DFPlayer restarts and a
+ *   watchdog reboot that skips the startup show
  * - LD1020 mode enables animation cooldown to prevent self-triggering
  * - BUTTON mode for "Try Me" functionality
+ * - Behaviors are bytecode scripts in flash (scripts.h)
+ * - FLOCK mode coordinates several crows over a shared serial bus
+ * - Directional tracking aims the head with a second sensor
  * 
  * >> "User Configuration" is located in settings.h <<
  * 
@@ -26,9 +34,24 @@
 #define SENSOR_MODE_NONE 2
 #define SENSOR_MODE_BUTTON 3  // connect button to PIN_MOTION_SENSOR/GND
 
+// FLOCK MODE CODES - Do not modify these values
+#define FLOCK_MODE_OFF 0
+#define FLOCK_MODE_LEADER 1
+#define FLOCK_MODE_FOLLOWER 2
+
 #include "settings.h"
 #include "animations.h"
+#include "calibration.h"
 #include "crow-utils.h"
+#include "flock.h"
+#include "power.h"
+#include "tracking.h"
+#include "motion.h"
+#include "health.h"
+#include "memory.h"
+#include "recorder.h"
+#include "behavior.h"
+#include "scripts.h"
 
 // ============================================================================
 // GLOBAL OBJECTS 
@@ -42,10 +65,23 @@ DFRobotDFPlayerMini dfPlayer;
 Adafruit_NeoPixel statusLED(1, PIN_NEOPIXEL, NEO_GRB + NEO_KHZ800);
 #endif
 
+#if FLOCK_MODE != FLOCK_MODE_OFF
+SerialPIO flockSerial(PIN_FLOCK_TX, PIN_FLOCK_RX);
+#endif
+FlockNode flock;
+
 // Neck position definitions
 const int NECK_CENTER = 0;
 const int NECK_SIDE = NECK_RANGE / 2;
 
+// Sensor polling interval (also the button debounce)
+const unsigned long SENSOR_POLL_MS = 50;
+
+// DFPlayer commands checkDFPlayer() sends itself
+const uint8_t DFPLAYER_CMD_SET_VOLUME = 0x06;
+const uint8_t DFPLAYER_CMD_RESET = 0x0C;
+const uint8_t DFPLAYER_CMD_VOLUME = 0x43;  // query
+
 // ============================================================================
 // STATE TRACKING
 // ============================================================================
@@ -57,21 +93,29 @@ enum CrowMode {
   MODE_RESETTING
 };
 
+enum DFPlayerCheck : uint8_t {
+  DFPLAYER_CHECK_NONE,
+  DFPLAYER_CHECK_QUERY,  // volume query sent, waiting for the reply
+  DFPLAYER_CHECK_RESET   // reset sent, waiting for the player to come up
+};
+
 volatile bool sensorCurrentlyHigh = false;
 volatile bool buttonDefaultState = HIGH;
 volatile bool buttonTriggered = false;
 bool buttonSequenceActive = false;
-unsigned long buttonWaitMs = 0;
-unsigned long lastButtonStepTime = 0;
-uint8_t buttonStep = 0;
+unsigned long buttonSequenceStart = 0;
+bool dfPlayerOnline = false;
+unsigned long lastDFPlayerCheck = 0;
+DFPlayerCheck dfPlayerCheck = DFPLAYER_CHECK_NONE;
+bool trackFollowPending = false;  // a crossing to follow once the crow is free
 
 CrowMode currentMode = MODE_IDLE;
+unsigned long modeStartTime = 0;
 unsigned long lastIdleMoveTime = 0;
 unsigned long nextIdleMoveTime = 0;
 unsigned long lastIdleSquawkTime = 0;
 unsigned long nextIdleSquawkTime = 0;
 unsigned long lastBlinkTime = 0;
-unsigned long nextBlinkTime = 0;
 unsigned long lastAudioTime = 0;
 unsigned long movementStart = 0;
 unsigned long movementEnd = 0;
@@ -80,11 +124,15 @@ unsigned long movementEnd = 0;
 // SETUP - CORE 0
 // ============================================================================
 void setup() {
+  healthBegin();
   Serial.begin(115200);
-  delay(7500);
+  if (!healthQuickStart) delay(7500);
 
   Serial.println(F("\n========================================"));
   Serial.println(F("Crow Animation Controller"));
+  if (healthQuickStart) {
+    Serial.println(F("*** WATCHDOG RESTART (quick start) ***"));
+  }
   if (TEST_MODE) {
     Serial.println(F("*** TEST MODE ACTIVE ***"));
     Serial.println(F("Eyes mirror sensor: ON=HIGH, OFF=LOW"));
@@ -101,23 +149,35 @@ void setup() {
   } else {
     Serial.println(F("*** NO SENSOR CONFIGURED ***"));
   }
+  if (FLOCK_MODE == FLOCK_MODE_LEADER) {
+    Serial.println(F("*** FLOCK LEADER ***"));
+  } else if (FLOCK_MODE == FLOCK_MODE_FOLLOWER) {
+    Serial.print(F("*** FLOCK FOLLOWER "));
+    Serial.print(FLOCK_NODE_ID);
+    Serial.println(F(" ***"));
+  }
   Serial.println(F("========================================\n"));
 
   initializeNeopixel();
   showPixel(0, 50, 0); // NeoPixel: green
 
-  randomSeed(analogRead(A0));
+  crowRandomSeed(recordSeed(analogRead(A0)));
 
+  initializeCalibration();
   initializeEyes();
   initializeBeak();
   initializeNeck();
   initializeDFPlayer();
+  initializeFlock();
 
   resetIdleTimers();
 
-  // Start up sensor and Core1 for monitoring if available
+  // Start up sensor and Core1 for monitoring (or the whole crow) if needed
   if (SENSOR_MODE != SENSOR_MODE_NONE) {
     initializeMotionSensor();
+  }
+  if (!CORE_SPLIT) initializeSleep();  // Core1 takes them in loop1() with CORE_SPLIT
+  if (SENSOR_MODE != SENSOR_MODE_NONE || CORE_SPLIT) {
     rp2040.resumeOtherCore();
   } else {
     rp2040.idleOtherCore();
@@ -125,6 +185,9 @@ void setup() {
 
   showPixel(0, 0, 0); // NeoPixel: off
   Serial.println(F("✓ Initialization complete. Crow is alive!"));
+  recordBegin();
+  motionBegin();
+  healthStart(SENSOR_MODE != SENSOR_MODE_NONE || CORE_SPLIT);
 }
 
 // ============================================================================
@@ -135,15 +198,34 @@ void setup1() {
 }
 
 // ============================================================================
-// LOOP - CORE 1 (Sensor Monitoring Thread)
+// LOOP - CORE 1 (Crow, or Sensor Monitoring Thread)
 // ============================================================================
 void loop1() {
+  healthBeat(1);
+  if (CORE_SPLIT) {
+    if (!motionSplit) {
+      delay(10);  // setup() has not handed over the neck yet
+      return;
+    }
+    static bool sleepReady = false;
+    if (!sleepReady) {
+      initializeSleep();  // the crow sleeps on this core now
+      sleepReady = true;
+    }
+    runCrow();
+    return;
+  }
   if (SENSOR_MODE == SENSOR_MODE_NONE) {
     delay(1000);  // Just sleep forever
     return;
   }
+  pollSensor();
+  delay(SENSOR_POLL_MS);
+}
+
+void pollSensor() {
+  if (SENSOR_MODE == SENSOR_MODE_NONE) return;
 
-  const unsigned long DEBOUNCE_MS = 50;
   if (SENSOR_MODE == SENSOR_MODE_BUTTON) {
     // Button mode: Detect state changes (debounced)
     static bool lastState = buttonDefaultState;
@@ -153,7 +235,7 @@ void loop1() {
 
     // Detect change from default state (button pressed)
     if (currentState != buttonDefaultState && currentState != lastState) {
-      if (millis() - lastChangeTime > DEBOUNCE_MS) {
+      if (millis() - lastChangeTime > SENSOR_POLL_MS) {
         if (!buttonSequenceActive) {
           buttonTriggered = true;
         }
@@ -162,12 +244,10 @@ void loop1() {
     }
 
     lastState = currentState;
-    delay(DEBOUNCE_MS);
 
   } else {
-    // PIR or LD1020 mode: Monitor for HIGH state
-    sensorCurrentlyHigh = digitalRead(PIN_MOTION_SENSOR);
-    delay(DEBOUNCE_MS);
+    // PIR or LD1020 mode: Monitor for HIGH state (on either sensor when tracking)
+    sensorCurrentlyHigh = digitalRead(PIN_MOTION_SENSOR) || (SENSOR_TRACKING && digitalRead(PIN_MOTION_SENSOR2));
   }
 }
 
@@ -175,13 +255,54 @@ void loop1() {
 // MAIN LOOP - CORE 0
 // ============================================================================
 void loop() {
+  healthWatch(millis());
+  if (CORE_SPLIT) {
+    motionLoop();  // neck and beak only: the crow runs on Core1
+    return;
+  }
+  runCrow();
+}
+
+// ============================================================================
+// CROW LOOP - CORE 0, or CORE 1 with CORE_SPLIT
+// ============================================================================
+void runCrow() {
+  // Sleep until the next scheduled event while the crow is at rest
+  recordLoopEnd();
+  idleSleep(millis());
+  recordLoopStart();
+
   unsigned long now = millis();
 
-  // Always run stepper
-  stepper.run();
+  if (CORE_SPLIT) {
+    // Poll the sensor every pass (Core0 is busy with the stepper)
+    pollSensor();
+  } else {
+    // Always run stepper
+    stepper.run();
+    motionMeasure(now, stepper.distanceToGo() != 0);
+
+    // Release the neck coils once settled
+    powerUpdate(now, stepper.distanceToGo() == 0);
+  }
+
+  // Animate Beak (Core0 writes the servo with CORE_SPLIT)
+  motionBeak(getEasedAnimPWM());
 
-  // Animate Beak 
-  updateBeak();
+  // Step the running behavior script
+  scriptUpdate(now);
+
+  powerReport(now);
+  motionReport();
+
+  // Record sensor input as seen by this core
+  recordInputs();
+  int command = Serial.available() > 0 ? Serial.read() : -1;
+  if (command == 'r') recordDump();
+  if (command == 'h') healthReport();
+
+  // Recover from stuck modes, stalled animations and a silent DFPlayer
+  checkHealth(now);
 
   // BUTTON MODE: Handle button sequence
   if (SENSOR_MODE == SENSOR_MODE_BUTTON) {
@@ -192,11 +313,7 @@ void loop() {
       handleBlinking(now);
     }
 
-    // Check for button trigger
-    if (buttonTriggered && !buttonSequenceActive) {
-      lastButtonStepTime = millis();
-      buttonStep = 0;
-    }
+    if (currentMode == MODE_RESETTING && motionNeckSettled()) setMode(MODE_IDLE);  // after a recovery
     executeButtonSequence(now);
     return;  // Skip all other mode logic
   }
@@ -208,6 +325,14 @@ void loop() {
     handleBlinking(now);
   }
 
+  // Flock Mode: service the bus and run actions scheduled by the leader
+  if (FLOCK_MODE != FLOCK_MODE_OFF) {
+    handleFlockAction(flockUpdate(flock, now));
+  }
+
+  // Tracking: pair sensor edges as they arrive (aims scolds and follow moves)
+  bool trackNew = SENSOR_TRACKING && trackUpdate(now);
+
   // LD1020 Mode: Check if cooldown period has elapsed
   bool ld1020Clear = true;
   if (SENSOR_MODE == SENSOR_MODE_LD1020) {
@@ -216,16 +341,22 @@ void loop() {
     if (!ld1020Clear) return;  // Skip other behaviors during cooldown
   }
 
+  if (trackNew) handleTrackEstimate();
+  followTrack(now);
+
   // Prevent rapidly-repeating squawks and scolds
   bool squawkEnabled = (now - lastAudioTime >= SCOLD_SQUAWK_BLOCK_MS);
 
-  // Scold when triggered and available
-  if (currentMode != MODE_SCOLDING && sensorCurrentlyHigh && !animating && squawkEnabled && ld1020Clear) {
+  // Scold when triggered and available (in a flock the leader decides who scolds)
+  bool scoldTrigger = currentMode != MODE_SCOLDING && sensorCurrentlyHigh && !animating && squawkEnabled && ld1020Clear;
+  bool flocking = flockOnline(flock, now);
+  flockSensor(flock, scoldTrigger && flocking, now);
+  if (scoldTrigger && !flocking) {
     Serial.println(F("[Scold]  Motion detected! Scolding..."));
     // Interrupt idle neck movement if in progress
-    if (currentMode == MODE_IDLE && stepper.distanceToGo() != 0) {
+    if (currentMode == MODE_IDLE && !motionNeckSettled()) {
       Serial.println(F("[Break]  Stopping idle movement for scold"));
-      stepper.stop();
+      motionStopNeck();
     }
     startScoldSequence();
     return;  // Skip other behaviors this loop
@@ -238,15 +369,15 @@ void loop() {
       break;
 
     case MODE_IDLE_MOVE:
-      if (stepper.distanceToGo() == 0) {
-        currentMode = MODE_IDLE;
+      if (!scriptRunning() && motionNeckSettled()) {
+        setMode(MODE_IDLE);
         movementEnd = millis();
       }
       break;
 
     case MODE_SCOLDING:
-      // Wait for animation to complete
-      if (!animating && stepper.distanceToGo() == 0) {
+      // Wait for the script (animation and neck) to complete
+      if (!scriptRunning()) {
         if (SENSOR_MODE == SENSOR_MODE_LD1020) {
           Serial.print(F("[LD1020] Scold complete, entering "));
           Serial.print(LD1020_ANIMATION_COOLDOWN_MS);
@@ -254,7 +385,7 @@ void loop() {
         } else {
           Serial.println(F("[Scold]  Complete. Returning to idle"));
         }
-        currentMode = MODE_IDLE;
+        setMode(MODE_IDLE);
         resetIdleMoveTime();
         addBlockToSquawkTime();
         lastAudioTime = millis();
@@ -263,9 +394,9 @@ void loop() {
       break;
 
     case MODE_SQUAWKING:
-      // Wait for animation to complete
-      if (!animating && stepper.distanceToGo() == 0) {
-        currentMode = MODE_IDLE;
+      // Wait for the script (animation and neck) to complete
+      if (!scriptRunning()) {
+        setMode(MODE_IDLE);
         Serial.println(F("[Squawk] Complete. Returning to idle"));
         lastAudioTime = millis();
         movementEnd = millis();
@@ -274,8 +405,8 @@ void loop() {
 
     case MODE_RESETTING:
       // Wait for neck to center
-      if (stepper.distanceToGo() == 0) {
-        currentMode = MODE_IDLE;
+      if (motionNeckSettled()) {
+        setMode(MODE_IDLE);
       }
       break;
   }
@@ -285,10 +416,41 @@ void loop() {
 // INITIALIZATION FUNCTIONS
 // ============================================================================
 
+void initializeCalibration() {
+  switch (loadCalibration()) {
+    case CAL_LOADED:
+      Serial.println(F("[Init]   Calibration loaded from flash"));
+      break;
+    case CAL_REBUILT:
+      Serial.println(F("[Init]   Calibration loaded from flash (easing table rebuilt)"));
+      break;
+    case CAL_EMPTY:
+      Serial.println(F("[Init]   No stored calibration, using settings.h"));
+      break;
+    case CAL_UNSUPPORTED:
+      Serial.println(F("[Init]   ✗ Stored calibration is from a newer version, using settings.h"));
+      break;
+    case CAL_CORRUPT:
+      Serial.println(F("[Init]   ✗ Stored calibration is corrupt, using settings.h"));
+      break;
+  }
+  if (crowCal.lagBaseMs > 0 || crowCal.lagTravelMs > 0) {
+    Serial.print(F("[Init]   Beak lead: "));
+    Serial.print(crowCal.lagBaseMs);
+    Serial.print(F("ms + "));
+    Serial.print(crowCal.lagTravelMs);
+    Serial.println(F("ms per full move"));
+  }
+}
+
 void initializeEyes() {
   pinMode(PIN_LED_EYES, OUTPUT);
   digitalWrite(PIN_LED_EYES, HIGH);
   Serial.println(F("[Init]   Eyes online"));
+  if (healthQuickStart) {
+    if (!TEST_MODE) digitalWrite(PIN_LED_EYES, LOW);
+    return;
+  }
   delay(500);
 
   if (!TEST_MODE) {
@@ -299,19 +461,23 @@ void initializeEyes() {
 
 void initializeBeak() {
   showPixel(25, 25, 25); // NeoPixel: white
-  int mid = (SERVO_PWM_OPEN + SERVO_PWM_CLOSED) / 2;
+  if (healthQuickStart) {  // no sweep: the servo stays detached until the next animation
+    Serial.println(F("[Init]   Beak servo online"));
+    return;
+  }
+  int mid = (crowCal.pwmOpen + crowCal.pwmClosed) / 2;
   beakServo.writeMicroseconds(mid);  // start center
-  beakServo.attach(PIN_SERVO, SERVO_PWM_OPEN, SERVO_PWM_CLOSED);
+  beakServo.attach(PIN_SERVO, crowCal.pwmOpen, crowCal.pwmClosed);
   delay(200);
-  for (int p = mid; p > SERVO_PWM_OPEN; p--) {  // move open
+  for (int p = mid; p > crowCal.pwmOpen; p--) {  // move open
     beakServo.writeMicroseconds(p);
     delay(2);
   }
-  for (int p = SERVO_PWM_OPEN; p < SERVO_PWM_CLOSED; p++) {  // move closed
+  for (int p = crowCal.pwmOpen; p < crowCal.pwmClosed; p++) {  // move closed
     beakServo.writeMicroseconds(p);
     delay(2);
   }
-  beakServo.writeMicroseconds(SERVO_PWM_CLOSED);
+  beakServo.writeMicroseconds(crowCal.pwmClosed);
   delay(200);
   beakServo.detach();
   Serial.println(F("[Init]   Beak servo online"));
@@ -338,7 +504,7 @@ void initializeNeck() {
   Serial.println(F("[Init]   Neck centered and online"));
 
   setNeckSpeedFast();
-  delay(500);
+  if (!healthQuickStart) delay(500);
 }
 
 void initializeDFPlayer() {
@@ -346,10 +512,19 @@ void initializeDFPlayer() {
   Serial1.setTX(PIN_DFPLAYER_TX);
   Serial1.setRX(PIN_DFPLAYER_RX);
   Serial1.begin(9600);
+
+  // A watchdog reboot left the DFPlayer running: skip its reset and the startup sound
+  if (healthQuickStart) {
+    dfPlayerOnline = dfPlayer.begin(Serial1, true, false);
+    if (dfPlayerOnline) dfPlayer.volume(crowCal.volume);
+    Serial.println(dfPlayerOnline ? F("[Init]   DFPlayer Mini online") : F("[Init]   ✗ DFPlayer Mini failed (retrying in the background)"));
+    return;
+  }
   delay(1000);
 
-  if (!dfPlayer.begin(Serial1, true, true)) {
-    Serial.println(F("[Init]   ✗ DFPlayer Mini failed!"));
+  dfPlayerOnline = dfPlayer.begin(Serial1, true, true);
+  if (!dfPlayerOnline) {
+    Serial.println(F("[Init]   ✗ DFPlayer Mini failed (retrying in the background)"));
     showPixel(50, 0, 0); // NeoPixel: red
     delay(2000);
   } else {
@@ -357,7 +532,7 @@ void initializeDFPlayer() {
     showPixel(50, 0, 50); // NeoPixel: purple
     
     delay(2000);
-    dfPlayer.volume(DFPLAYER_VOLUME);
+    dfPlayer.volume(crowCal.volume);
     delay(200);
     dfPlayer.play(11);
   }
@@ -376,6 +551,7 @@ void initializeMotionSensor() {
     Serial.println(F("[Init]   Button sensor online (INPUT_PULLUP)"));
     Serial.print(F("[Init]   Button default state: "));
     Serial.println(buttonDefaultState == HIGH ? "HIGH (NO)" : "LOW (NC)");
+    if (healthQuickStart) return;
     Serial.println(F("[Init]   Waiting for button press test..."));
 
     unsigned long startTime = millis();
@@ -404,6 +580,7 @@ void initializeMotionSensor() {
     showPixel(0, 0, 50); // NeoPixel: blue
 
     Serial.println(F("[Init]   Motion sensor online"));
+    if (healthQuickStart) return;
     Serial.println(F("[Init]   Waiting for motion test..."));
 
     unsigned long startTime = millis();
@@ -426,6 +603,29 @@ void initializeMotionSensor() {
   delay(500);
 }
 
+void initializeFlock() {
+#if FLOCK_MODE != FLOCK_MODE_OFF
+  flockSerial.begin(FLOCK_BAUD);
+  flockBegin(flock, FLOCK_NODE_ID, flockSerial);
+  Serial.print(F("[Init]   Flock bus online as node "));
+  Serial.print(FLOCK_NODE_ID);
+  Serial.print(F(" of "));
+  Serial.println(FLOCK_NODE_COUNT);
+#endif
+}
+
+// the sleep alarm and the sensor interrupts, on the core that runs the crow
+void initializeSleep() {
+  powerBegin(SENSOR_MODE != SENSOR_MODE_NONE && !SENSOR_TRACKING);
+  initializeTracking();
+}
+
+void initializeTracking() {
+  if (!SENSOR_TRACKING) return;
+  trackBegin();
+  Serial.println(F("[Init]   Directional tracking online (SENSOR1 + SENSOR2)"));
+}
+
 void initializeNeopixel() {
   // Initialize status LED (conditional)
 #if SHOW_NEOPIXEL_STATUS
@@ -441,86 +641,30 @@ void initializeNeopixel() {
 // ============================================================================
 
 void executeButtonSequence(unsigned long now) {
-  if (buttonTriggered) {
-    if (!buttonSequenceActive) {
-      buttonSequenceActive = true;
-      Serial.println(F("[Button] ===== STARTING BUTTON SEQUENCE ====="));
-    }
+  if (!buttonTriggered) return;
 
-    // Check if we need to wait before advancing
-    if (now - lastButtonStepTime < buttonWaitMs) return;
-
-    switch (buttonStep) {
-      case 0:
-        Serial.println(F("[Button] Eyes ON"));
-        digitalWrite(PIN_LED_EYES, HIGH);
-        nextBlinkTime = now + random(BLINK_MIN_INTERVAL_MS, BLINK_MAX_INTERVAL_MS);
-        buttonWaitMs = 800;
-        lastButtonStepTime = now;
-        buttonStep++;
-        break;
-      case 1:
-        Serial.println(F("[Button] Scolding"));
-        startScoldSequence();
-        buttonStep++;
-        break;
-      case 2:
-        if (!animating && stepper.distanceToGo() == 0) {
-          buttonWaitMs = random(1000, 3000);
-          lastButtonStepTime = now;
-          buttonStep++;
-        }
-        break;
-      case 3:
-        Serial.println(F("[Button] Movement"));
-        startIdleMove(now);
-        buttonStep++;
-        break;
-      case 4:
-        if (stepper.distanceToGo() == 0) {
-          buttonWaitMs = random(1200, 2400);
-          lastButtonStepTime = now;
-          buttonStep++;
-        }
-        break;
-      case 5:
-        Serial.println(F("[Button] Squawk"));
-        animateAudio(random(8, 15));
-        buttonStep++;
-        break;
-      case 6:
-        if (!animating && stepper.distanceToGo() == 0) {
-          buttonWaitMs = random(1000, 3000);
-          lastButtonStepTime = now;
-          buttonStep++;
-        }
-        break;
-      case 7:
-        Serial.println(F("[Button] Centering Neck"));
-        setNeckSpeedSlow();
-        stepper.moveTo(NECK_CENTER);
-        buttonStep++;
-      case 8:
-        if (stepper.distanceToGo() == 0) {
-          Serial.println(F("[Button] Eyes OFF"));
-          digitalWrite(PIN_LED_EYES, LOW);
-          Serial.println(F("[Button] ===== SEQUENCE COMPLETE ====="));
-          buttonSequenceActive = false;
-          buttonTriggered = false;
-        }
-        break;
-    }
+  if (!buttonSequenceActive) {
+    buttonSequenceActive = true;
+    buttonSequenceStart = now;
+    Serial.println(F("[Button] ===== STARTING BUTTON SEQUENCE ====="));
+    scriptStart(scriptTryMe);
+  }
+
+  if (!scriptRunning()) {
+    Serial.println(F("[Button] ===== SEQUENCE COMPLETE ====="));
+    buttonSequenceActive = false;
+    buttonTriggered = false;
   }
 }
 
 void handleIdleMode(unsigned long now, bool squawkEnabled, bool ld1020Clear) {
 
   // Random neck movements
-  if (ld1020Clear && now >= nextIdleMoveTime && stepper.distanceToGo() == 0 && !animating) {
+  if (ld1020Clear && now >= nextIdleMoveTime && motionNeckSettled() && !animating) {
 
     // Randomly scold if there is no sensor
     if (SENSOR_MODE == SENSOR_MODE_NONE) {
-      if (squawkEnabled && random(0, 4) == 0) {
+      if (squawkEnabled && crowRandom(0, 4) == 0) {
         Serial.println(F("[Scold]  Idle scold! Scolding..."));
         startScoldSequence();
         resetIdleMoveTime();
@@ -528,7 +672,7 @@ void handleIdleMode(unsigned long now, bool squawkEnabled, bool ld1020Clear) {
       }
     }
     // Trigger idle movement and (re)set volume
-    dfPlayer.volume(DFPLAYER_VOLUME);
+    dfPlayer.volume(crowCal.volume);
     startIdleMove(now);
   }
 
@@ -539,52 +683,92 @@ void handleIdleMode(unsigned long now, bool squawkEnabled, bool ld1020Clear) {
   }
 }
 
+void setMode(CrowMode mode) {
+  if (mode != currentMode) {
+    recordModeChange(currentMode, mode);
+    modeStartTime = millis();
+  }
+  currentMode = mode;
+}
+
 void startScoldSequence() {
-  currentMode = MODE_SCOLDING;
+  setMode(MODE_SCOLDING);
   movementStart = millis();
   lastAudioTime = millis();
-
-  // Move neck to +/- 20% position
-  setNeckSpeedFast();
-  int rangePercent = random(0, NECK_RANGE_SCOLD_PERCENT + 1);
-  int direction = random(0, 2) == 0 ? 1 : -1;
-  int scoldPos = (NECK_SIDE * rangePercent / 100) * direction;
-  stepper.moveTo(scoldPos);
-
-  Serial.print(F("[Scold]  Turning head to "));
-  Serial.println(scoldPos);
-  // Choose random scold sound (tracks 1-7)
-  animateAudio(random(1, 8));
+  scriptStart(scriptScold);
 }
 
 void startIdleSquawk() {
   Serial.println(F("[Squawk] Random squawk..."));
-  currentMode = MODE_SQUAWKING;
+  setMode(MODE_SQUAWKING);
   movementStart = millis();
   lastAudioTime = millis();
-  // Choose random squawk sound (tracks 8-14)
-  animateAudio(random(8, 15));
+  scriptStart(scriptSquawk);
 }
 
-void startIdleMove(unsigned long now) {
-  // Randomly choose slow or fast movement
-  if (random(0, 2) == 0) setNeckSpeedFast();
-  else setNeckSpeedSlow();
+void handleFlockAction(uint8_t action) {
+  if (action == FLOCK_ACTION_NONE) return;
+  // Busy crows skip their part of the wave
+  if (currentMode == MODE_SCOLDING || animating) return;
+
+  if (action == FLOCK_ACTION_SCOLD) {
+    Serial.println(F("[Flock]  Leader scheduled scold. Scolding..."));
+    if (currentMode == MODE_IDLE_MOVE && !motionNeckSettled()) {
+      motionStopNeck();
+    }
+    startScoldSequence();
+    return;
+  }
 
-  // Generate random position: 30-100% of range in either direction
-  int rangePercent = random(IDLE_NECK_MIN_PERCENT, IDLE_NECK_MAX_PERCENT + 1);
-  int direction = random(0, 2) == 0 ? 1 : -1;  // Left or right
-  int targetPos = (NECK_SIDE * rangePercent / 100) * direction;
+  int direction = (action == FLOCK_ACTION_TURN_UP) ? FLOCK_TURN_DIRECTION : -FLOCK_TURN_DIRECTION;
+  int targetPos = (NECK_SIDE * FLOCK_TURN_PERCENT / 100) * direction;
+  setNeckSpeedFast();
+  moveNeckTo(targetPos);
 
-  stepper.moveTo(targetPos);
+  Serial.print(F("[Flock]  Turning toward scold at "));
+  Serial.println(targetPos);
+  setMode(MODE_IDLE_MOVE);
+  movementStart = millis();
+  resetIdleMoveTime();
+}
 
-  Serial.print(F("[Idle]   Moving neck to "));
-  Serial.print(targetPos);
-  Serial.print(F(" ("));
-  Serial.print(rangePercent);
-  Serial.println(F("% range)"));
-  currentMode = MODE_IDLE_MOVE;
+void handleTrackEstimate() {
+  Serial.print(trackLast.crossing ? F("[Track]  Crossing to side ") : F("[Track]  Arrival on side "));
+  Serial.print(trackLast.side);
+  Serial.print(F(", speed "));
+  Serial.print(trackLast.speedPercent);
+  Serial.print(F("% (decided "));
+  Serial.print(trackDecisionUs);
+  Serial.println(F("us after the edge)"));
+
+  // An arrival aims the scold it triggers; a crossing also turns the head to
+  // follow, once the crow is free (the latest estimate replaces a held one)
+  trackFollowPending = trackLast.crossing;
+}
+
+// turns the head after the last crossing unless a scold, squawk or script is
+// moving it (held until they end)
+void followTrack(unsigned long now) {
+  if (!trackFollowPending || scriptRunning()) return;
+  if (currentMode != MODE_IDLE && currentMode != MODE_IDLE_MOVE) return;
+  trackFollowPending = false;
+  int targetPos = getTrackAimPosition();
+  setNeckSpeedFast();
+  moveNeckTo(targetPos);
+  Serial.print(F("[Track]  Following to "));
+  Serial.println(targetPos);
+  if (currentMode == MODE_IDLE) {
+    setMode(MODE_IDLE_MOVE);
+    movementStart = now;
+    resetIdleMoveTime();
+  }
+}
+
+void startIdleMove(unsigned long now) {
+  Serial.println(F("[Idle]   Random neck movement..."));
+  setMode(MODE_IDLE_MOVE);
   movementStart = now;
+  scriptStart(scriptIdleMove);
 
   resetIdleMoveTime();
 }
@@ -595,11 +779,11 @@ void resetIdleTimers() {
 }
 
 void resetIdleMoveTime() {
-  nextIdleMoveTime = millis() + random(IDLE_MOVE_MIN_MS, IDLE_MOVE_MAX_MS);
+  nextIdleMoveTime = millis() + crowRandom(IDLE_MOVE_MIN_MS, IDLE_MOVE_MAX_MS);
 }
 
 void resetIdleSquawkTime() {
-  nextIdleSquawkTime = millis() + random(IDLE_SQUAWK_MIN_MS, IDLE_SQUAWK_MAX_MS);
+  nextIdleSquawkTime = millis() + crowRandom(IDLE_SQUAWK_MIN_MS, IDLE_SQUAWK_MAX_MS);
 }
 
 void addBlockToSquawkTime() {
@@ -611,24 +795,19 @@ void addBlockToSquawkTime() {
 // ============================================================================
 
 void setNeckSpeedSlow() {
-  stepper.setMaxSpeed(NECK_SPEED_SLOW_MAX);
-  stepper.setAcceleration(NECK_SPEED_SLOW_ACCEL);
+  motionNeckSpeed(crowCal.neckSlowMax, crowCal.neckSlowAccel);
 }
 
 void setNeckSpeedFast() {
-  stepper.setMaxSpeed(NECK_SPEED_FAST_MAX);
-  stepper.setAcceleration(NECK_SPEED_FAST_ACCEL);
+  motionNeckSpeed(crowCal.neckFastMax, crowCal.neckFastAccel);
 }
 
-void resetNeckToCenter() {
-  stepper.stop();
-  setNeckSpeedFast();
-  stepper.moveTo(NECK_CENTER);
+void moveNeckTo(long position) {
+  motionMoveNeck(position);
+}
 
-  // Wait for completion
-  while (stepper.distanceToGo() != 0) {
-    stepper.run();
-  }
+int getTrackAimPosition() {
+  return (NECK_SIDE * trackLast.aimPercent / 100) * trackLast.side;
 }
 
 // ============================================================================
@@ -645,37 +824,243 @@ void animateAudio(uint8_t trackNum) {
     Serial.println(millis() / 1000);
 
     dfPlayer.play(trackNum);
+    recordTrack(trackNum);
 
     // queue animation with delay to get DFPlayer started
-    queuePendingAnimation(idx, millis() + AUDIO_SYNC_DELAY_MS);
+    queuePendingAnimation(idx, millis() + crowCal.audioSyncDelayMs);
   } else {
     Serial.println(F("✗ Audio  Track index out of bounds!"));
   }
 }
 
 // ============================================================================
-// EYE BLINKING
+// SCRIPT HOOKS (see behavior.h)
 // ============================================================================
 
-void handleBlinking(unsigned long now) {
-  static bool eyesOpen = true;
-  static unsigned long blinkStartTime = 0;
+// true once the beak animation (including a queued one) and the neck are done
+bool scriptIdle() {
+  return !animating && pendingAnimation == nullptr && motionNeckSettled();
+}
+
+bool scriptSensor() {
+  return sensorCurrentlyHigh;
+}
 
-  if (eyesOpen) {
-    // Check if it's time to blink
-    if (now >= nextBlinkTime) {
-      digitalWrite(PIN_LED_EYES, LOW);
-      eyesOpen = false;
-      blinkStartTime = now;
-    }
+void scriptPlay(uint8_t track) {
+  animateAudio(track);
+}
+
+void scriptNeckSpeed(bool fast) {
+  if (fast) setNeckSpeedFast();
+  else setNeckSpeedSlow();
+}
+
+void scriptNeck(int percent) {
+  int targetPos = NECK_SIDE * percent / 100;
+  moveNeckTo(targetPos);
+  Serial.print(F("[Script] Moving neck to "));
+  Serial.print(targetPos);
+  Serial.print(F(" ("));
+  Serial.print(percent);
+  Serial.println(F("% range)"));
+}
+
+// toward the tracked visitor, otherwise a random 0-maxPercent to either side
+void scriptNeckToward(uint8_t maxPercent) {
+  int targetPos;
+  if (SENSOR_TRACKING && trackFresh(millis())) {
+    targetPos = getTrackAimPosition();
   } else {
-    // Check if blink is complete
-    if (now - blinkStartTime >= BLINK_DURATION_MS) {
-      digitalWrite(PIN_LED_EYES, HIGH);
-      eyesOpen = true;
-      nextBlinkTime = now + random(BLINK_MIN_INTERVAL_MS, BLINK_MAX_INTERVAL_MS);
+    int rangePercent = crowRandom(0, maxPercent + 1);
+    int direction = crowRandom(0, 2) == 0 ? 1 : -1;
+    targetPos = (NECK_SIDE * rangePercent / 100) * direction;
+  }
+  moveNeckTo(targetPos);
+  Serial.print(F("[Script] Turning head to "));
+  Serial.println(targetPos);
+}
+
+void scriptEyes(bool on) {
+  digitalWrite(PIN_LED_EYES, on ? HIGH : LOW);
+  if (on) nextBlinkTime = millis() + crowRandom(BLINK_MIN_INTERVAL_MS, BLINK_MAX_INTERVAL_MS);
+}
+
+// ============================================================================
+// HEALTH CHECKS (see health.h)
+// ============================================================================
+
+void checkHealth(unsigned long now) {
+  healthLog();
+  if (healthRebooting) return;  // waiting for the watchdog
+
+  // Beak animation running past its end
+  if (animating && (long)(now - animationEndTime) > HEALTH_ANIM_GRACE_MS) {
+    healthFault(FAULT_ANIM_STALL);
+    animating = false;
+    motionBeak(-1);
+  }
+
+  // A mode (or the button sequence) outliving any behavior
+  bool modeStuck = currentMode != MODE_IDLE && now - modeStartTime >= HEALTH_MODE_TIMEOUT_MS;
+  bool sequenceStuck = buttonSequenceActive && now - buttonSequenceStart >= HEALTH_MODE_TIMEOUT_MS;
+  if (modeStuck || sequenceStuck) {
+    healthFault(FAULT_MODE_STUCK);
+    if (currentMode == MODE_RESETTING) {
+      healthReboot();  // the neck never came back to center
+      return;
+    }
+    recoverCrow();
+  }
+
+  checkDFPlayer(now);
+}
+
+// drops whatever the crow was doing and centers the neck
+void recoverCrow() {
+  Serial.println(F("[Health] Resetting the crow"));
+  scriptStop();
+  animating = false;
+  pendingAnimation = nullptr;
+  motionBeak(-1);
+  buttonSequenceActive = false;
+  buttonTriggered = false;
+  if (SENSOR_MODE == SENSOR_MODE_BUTTON) digitalWrite(PIN_LED_EYES, LOW);
+  setNeckSpeedFast();
+  moveNeckTo(NECK_CENTER);
+  setMode(MODE_RESETTING);
+  resetIdleTimers();
+}
+
+// sends a command to the DFPlayer without waiting for its reply (the
+// library's readVolume() and reset() wait up to seconds for one)
+void dfPlayerSend(uint8_t command, uint16_t param) {
+  uint8_t frame[10] = {0x7E, 0xFF, 0x06, command, 0x00, (uint8_t)(param >> 8), (uint8_t)param, 0, 0, 0xEF};
+  uint16_t sum = 0;
+  for (uint8_t i = 1; i < 7; i++) sum -= frame[i];
+  frame[7] = sum >> 8;
+  frame[8] = sum;
+  Serial1.write(frame, sizeof(frame));
+}
+
+// checks (or restarts) the DFPlayer in the background: the query or reset
+// goes out while the crow is at rest (so its reply is not mixed up with a
+// track's), and later passes pick up the reply or give up on it
+void checkDFPlayer(unsigned long now) {
+  if (dfPlayerCheck != DFPLAYER_CHECK_NONE) {
+    while (dfPlayer.available()) {
+      uint8_t type = dfPlayer.readType();
+      if (dfPlayerCheck == DFPLAYER_CHECK_QUERY && type == DFPlayerFeedBack && dfPlayer.readCommand() == DFPLAYER_CMD_VOLUME) {
+        dfPlayerCheck = DFPLAYER_CHECK_NONE;
+        return;
+      }
+      if (dfPlayerCheck == DFPLAYER_CHECK_RESET && (type == DFPlayerCardOnline || type == DFPlayerUSBOnline)) {
+        dfPlayerSend(DFPLAYER_CMD_SET_VOLUME, crowCal.volume);
+        dfPlayerOnline = true;
+        dfPlayerCheck = DFPLAYER_CHECK_NONE;
+        Serial.println(F("[Health] DFPlayer Mini back online"));
+        return;
+      }
     }
+    if (now - lastDFPlayerCheck < HEALTH_DFPLAYER_REPLY_MS) return;
+    if (dfPlayerCheck == DFPLAYER_CHECK_QUERY) {
+      healthFault(FAULT_DFPLAYER);
+      dfPlayerOnline = false;
+    }
+    dfPlayerCheck = DFPLAYER_CHECK_NONE;
+    return;
+  }
+
+  if (currentMode != MODE_IDLE || animating || pendingAnimation != nullptr || scriptRunning() || buttonSequenceActive) return;
+
+  if (dfPlayerOnline) {
+    if (HEALTH_DFPLAYER_CHECK_MS == 0 || now - lastDFPlayerCheck < HEALTH_DFPLAYER_CHECK_MS) return;
+    dfPlayerCheck = DFPLAYER_CHECK_QUERY;
+  } else if (now - lastDFPlayerCheck >= HEALTH_DFPLAYER_RETRY_MS) {
+    Serial.println(F("[Health] Restarting DFPlayer Mini..."));
+    dfPlayerCheck = DFPLAYER_CHECK_RESET;
+  } else {
+    return;
+  }
+  lastDFPlayerCheck = now;
+  while (dfPlayer.available()) dfPlayer.readType();  // drop feedback nobody read
+  dfPlayerSend(dfPlayerCheck == DFPLAYER_CHECK_QUERY ? DFPLAYER_CMD_VOLUME : DFPLAYER_CMD_RESET, 0);
+}
+
+// ============================================================================
+// SESSION RECORDING
+// ============================================================================
+
+void recordInputs() {
+  static bool lastSensor = false;
+  static bool lastButton = false;
+
+  if (sensorCurrentlyHigh != lastSensor) {
+    lastSensor = sensorCurrentlyHigh;
+    recordSensor(lastSensor);
+  }
+  if (buttonTriggered != lastButton) {
+    lastButton = buttonTriggered;
+    if (lastButton) recordButton();
+  }
+}
+
+// the crow at rest, for a recorder checkpoint
+void recordSnapshot(RecordState& s) {
+  s.random = crowRandomState;
+  s.nextMoveMs = recordTime(nextIdleMoveTime);
+  s.nextSquawkMs = recordTime(nextIdleSquawkTime);
+  s.nextBlinkMs = recordTime(nextBlinkTime);
+  s.lastAudioMs = recordTime(lastAudioTime);
+  s.movementStartMs = recordTime(movementStart);
+  s.movementEndMs = recordTime(movementEnd);
+  s.neckPosition = stepper.currentPosition();  // settled, so Core0 is not changing it
+  s.mode = currentMode;
+  s.eyesOpen = eyesOpen;
+  s.sensor = sensorCurrentlyHigh;
+  s.button = buttonTriggered;
+}
+
+// crow-replay: puts the crow back the way a checkpoint found it
+void recordRestore(const RecordState& s) {
+  crowRandomState = s.random;
+  nextIdleMoveTime = recordClock(s.nextMoveMs);
+  nextIdleSquawkTime = recordClock(s.nextSquawkMs);
+  nextBlinkTime = recordClock(s.nextBlinkMs);
+  lastAudioTime = recordClock(s.lastAudioMs);
+  movementStart = recordClock(s.movementStartMs);
+  movementEnd = recordClock(s.movementEndMs);
+  stepper.setCurrentPosition(s.neckPosition);
+  motionStaged.neckTarget = s.neckPosition;
+  currentMode = (CrowMode)s.mode;
+  modeStartTime = millis();
+  eyesOpen = s.eyesOpen;
+  if (!TEST_MODE) digitalWrite(PIN_LED_EYES, eyesOpen ? HIGH : LOW);
+  sensorCurrentlyHigh = s.sensor;
+  buttonTriggered = s.button;
+}
+
+// ============================================================================
+// LOW-POWER IDLE
+// ============================================================================
+
+void idleSleep(unsigned long now) {
+  // Only sleep when nothing is moving or about to move
+  if (!motionNeckSettled() || animating || pendingAnimation != nullptr || scriptRunning()) return;
+  if (SENSOR_MODE == SENSOR_MODE_BUTTON) {
+    if (buttonTriggered || buttonSequenceActive) return;
+    recordRest(now);
+    powerSleepUntil(now, now + POWER_MAX_SLEEP_MS);
+    return;
   }
+  if (currentMode != MODE_IDLE || sensorCurrentlyHigh) return;
+  recordRest(now);
+
+  PowerSchedule schedule = {
+    nextBlinkTime, nextIdleSquawkTime, nextIdleMoveTime, lastAudioTime, max(movementEnd, movementStart),
+    SENSOR_MODE == SENSOR_MODE_LD1020, !TEST_MODE, FLOCK_MODE != FLOCK_MODE_OFF
+  };
+  unsigned long deadline = powerIdleDeadline(now, schedule);
+  powerSleepUntil(now, deadline);
 }
 
 // ============================================================================
@@ -0,0 +1,260 @@
+// ============================================================================
+// BEHAVIOR SCRIPT INTERPRETER
+// ============================================================================
+// Behaviors are short bytecode scripts kept in flash (scripts.h). One script
+// runs at a time: scriptUpdate() is called from every loop and executes
+// instructions until one has to wait (at most SCRIPT_MAX_STEPS per call), so
+// stepper.run() is never starved. Nothing is allocated.
+//
+// An instruction is an opcode byte followed by its arguments (16-bit arguments
+// low byte first). Jumps name a label (S_LABEL) in the same script rather
+// than an instruction index, so lines can be added without renumbering, and
+// scriptCheck() verifies every script at compile time (see the end of
+// scripts.h).
+//
+// The sketch provides the hooks (scriptPlay(), scriptNeck(), ...) that do the
+// actual work, so scripts drive the crow through the same functions as loop().
+#ifndef BEHAVIOR_H
+#define BEHAVIOR_H
+
+#include <Arduino.h>
+#include "crow-random.h"
+
+#define SCRIPT_MAX_STEPS      16    // instructions per scriptUpdate() call
+
+enum ScriptOp : uint8_t {
+  OP_END,          //                  stop
+  OP_WAIT,         // ms(16)           wait ms
+  OP_WAIT_RANDOM,  // min(16) max(16)  wait min to max ms
+  OP_WAIT_IDLE,    //                  wait for the beak animation and neck to finish
+  OP_PLAY,         // first last       play a random track first-last with its beak animation
+  OP_NECK_SPEED,   // speed            NECK_SLOW, NECK_FAST or NECK_EITHER
+  OP_NECK,         // percent(signed)  move the neck to percent of one side (+ or -)
+  OP_NECK_RANDOM,  // min max          move the neck min-max percent to a random side
+  OP_NECK_TOWARD,  // max              turn toward the tracked visitor, else 0-max percent to a random side
+  OP_EYES,         // on               eyes on (1) or off (0)
+  OP_IF_SENSOR,    // label            jump if the motion sensor is high
+  OP_CHANCE,       // percent label    jump percent of the time
+  OP_JUMP,         // label            jump
+  OP_LABEL,        // label            jump target (does nothing)
+  OP_COUNT
+};
+
+// bytes per instruction, by opcode
+constexpr uint8_t scriptOpSize[OP_COUNT] = {1, 3, 5, 1, 3, 2, 2, 3, 2, 2, 2, 3, 2, 2};
+
+#define NECK_SLOW             0
+#define NECK_FAST             1
+#define NECK_EITHER           2
+
+// Script text: one instruction per macro
+#define S_END                        OP_END
+#define S_WAIT(ms)                   OP_WAIT, (uint8_t)(ms), (uint8_t)((ms) >> 8)
+#define S_WAIT_RANDOM(min, max)      OP_WAIT_RANDOM, (uint8_t)(min), (uint8_t)((min) >> 8), (uint8_t)(max), (uint8_t)((max) >> 8)
+#define S_WAIT_IDLE                  OP_WAIT_IDLE
+#define S_PLAY(first, last)          OP_PLAY, (first), (last)
+#define S_NECK_SPEED(speed)          OP_NECK_SPEED, (speed)
+#define S_NECK(percent)              OP_NECK, (uint8_t)(int8_t)(percent)
+#define S_NECK_RANDOM(min, max)      OP_NECK_RANDOM, (min), (max)
+#define S_NECK_TOWARD(max)           OP_NECK_TOWARD, (max)
+#define S_EYES(on)                   OP_EYES, (on)
+#define S_IF_SENSOR(label)           OP_IF_SENSOR, (label)
+#define S_CHANCE(percent, label)     OP_CHANCE, (percent), (label)
+#define S_JUMP(label)                OP_JUMP, (label)
+#define S_LABEL(label)               OP_LABEL, (label)
+
+// Hooks (provided by the sketch)
+bool scriptIdle();
+bool scriptSensor();
+void scriptPlay(uint8_t track);
+void scriptNeckSpeed(bool fast);
+void scriptNeck(int percent);
+void scriptNeckToward(uint8_t maxPercent);
+void scriptEyes(bool on);
+
+// Script State
+static const uint8_t* scriptCode = nullptr;
+static uint16_t scriptPc = 0;
+static unsigned long scriptWaitStart = 0;
+static unsigned long scriptWaitMs = 0;
+static bool scriptWaitIdle = false;
+
+void scriptStop() {
+  scriptCode = nullptr;
+}
+
+bool scriptRunning() {
+  return scriptCode != nullptr;
+}
+
+uint8_t scriptArg(uint16_t at) {
+  return pgm_read_byte(&scriptCode[at]);
+}
+
+uint16_t scriptArg16(uint16_t at) {
+  return scriptArg(at) | (scriptArg(at + 1) << 8);
+}
+
+// moves to label by walking from the start (scripts are short); a missing
+// label (which scriptCheck() rules out) ends the script
+void scriptJump(uint8_t label) {
+  uint16_t pc = 0;
+  for (;;) {
+    uint8_t op = scriptArg(pc);
+    if (op >= OP_COUNT || op == OP_END) break;
+    if (op == OP_LABEL && scriptArg(pc + 1) == label) break;
+    pc += scriptOpSize[op];
+  }
+  scriptPc = pc;
+}
+
+// runs the script until it waits or ends; true while it is running
+bool scriptUpdate(unsigned long now) {
+  if (scriptCode == nullptr) return false;
+
+  if (scriptWaitIdle) {
+    if (!scriptIdle()) return true;
+    scriptWaitIdle = false;
+  }
+  if (scriptWaitMs > 0) {
+    if (now - scriptWaitStart < scriptWaitMs) return true;
+    scriptWaitMs = 0;
+  }
+
+  for (uint8_t step = 0; step < SCRIPT_MAX_STEPS; step++) {
+    uint16_t pc = scriptPc;
+    uint8_t op = scriptArg(pc);
+    if (op >= OP_COUNT) op = OP_END; // not a script
+    scriptPc += scriptOpSize[op];
+
+    switch (op) {
+      case OP_END:
+        scriptCode = nullptr;
+        return false;
+      case OP_WAIT:
+        scriptWaitStart = now;
+        scriptWaitMs = scriptArg16(pc + 1);
+        return true;
+      case OP_WAIT_RANDOM:
+        scriptWaitStart = now;
+        scriptWaitMs = crowRandom(scriptArg16(pc + 1), scriptArg16(pc + 3));
+        return true;
+      case OP_WAIT_IDLE:
+        if (!scriptIdle()) {
+          scriptWaitIdle = true;
+          return true;
+        }
+        break;
+      case OP_PLAY:
+        scriptPlay(crowRandom(scriptArg(pc + 1), scriptArg(pc + 2) + 1));
+        break;
+      case OP_NECK_SPEED: {
+        uint8_t speed = scriptArg(pc + 1);
+        scriptNeckSpeed(speed == NECK_EITHER ? crowRandom(0, 2) == 0 : speed == NECK_FAST);
+        break;
+      }
+      case OP_NECK:
+        scriptNeck((int8_t)scriptArg(pc + 1));
+        break;
+      case OP_NECK_RANDOM: {
+        int percent = crowRandom(scriptArg(pc + 1), scriptArg(pc + 2) + 1);
+        scriptNeck(crowRandom(0, 2) == 0 ? percent : -percent);
+        break;
+      }
+      case OP_NECK_TOWARD:
+        scriptNeckToward(scriptArg(pc + 1));
+        break;
+      case OP_EYES:
+        scriptEyes(scriptArg(pc + 1));
+        break;
+      case OP_IF_SENSOR:
+        if (scriptSensor()) scriptJump(scriptArg(pc + 1));
+        break;
+      case OP_CHANCE:
+        if (crowRandom(0, 100) < scriptArg(pc + 1)) scriptJump(scriptArg(pc + 2));
+        break;
+      case OP_JUMP:
+        scriptJump(scriptArg(pc + 1));
+        break;
+      case OP_LABEL:
+        break;
+    }
+  }
+  return true; // step budget used: continue next loop
+}
+
+// replaces the running script and runs it up to its first wait
+void scriptStart(const uint8_t* script) {
+  scriptCode = script;
+  scriptPc = 0;
+  scriptWaitMs = 0;
+  scriptWaitIdle = false;
+  scriptUpdate(millis());
+}
+
+// ============================================================================
+// SCRIPT CHECKS
+// ============================================================================
+// Evaluated by the compiler: scripts.h static_asserts scriptCheck() for every
+// script, so a bad script fails the build instead of misbehaving on the crow.
+
+// true if code (size bytes) is whole instructions ending with S_END
+constexpr bool scriptWellFormed(const uint8_t* code, uint16_t size) {
+  uint16_t pc = 0;
+  uint8_t op = OP_END;
+  while (pc < size) {
+    op = code[pc];
+    if (op >= OP_COUNT) return false;
+    pc += scriptOpSize[op];
+  }
+  return size > 0 && pc == size && op == OP_END;
+}
+
+// provides where label is defined, or -1 if it is not defined exactly once
+constexpr int scriptFindLabel(const uint8_t* code, uint16_t size, uint8_t label) {
+  int at = -1;
+  for (uint16_t pc = 0; pc < size; pc += scriptOpSize[code[pc]]) {
+    if (code[pc] != OP_LABEL || code[pc + 1] != label) continue;
+    if (at >= 0) return -1;
+    at = pc;
+  }
+  return at;
+}
+
+// provides the most instructions one scriptUpdate() can run starting at pc
+// before it has to wait or end (more than SCRIPT_MAX_STEPS: gave up counting)
+constexpr uint8_t scriptBurst(const uint8_t* code, uint16_t size, uint16_t pc, uint8_t run = 1) {
+  if (run > SCRIPT_MAX_STEPS) return run;
+  uint8_t op = code[pc];
+  if (op == OP_END || op == OP_WAIT || op == OP_WAIT_RANDOM) return run;
+  uint8_t most = 0;
+  if (op != OP_JUMP) most = scriptBurst(code, size, pc + scriptOpSize[op], run + 1);
+  if (op == OP_IF_SENSOR || op == OP_CHANCE || op == OP_JUMP) {
+    uint8_t label = code[pc + (op == OP_CHANCE ? 2 : 1)];
+    uint8_t jumped = scriptBurst(code, size, scriptFindLabel(code, size, label), run + 1);
+    if (jumped > most) most = jumped;
+  }
+  return most;
+}
+
+// true if every jump names a label defined once in the script, and however
+// its branches go the script waits (or ends) within SCRIPT_MAX_STEPS, so no
+// pass is cut short and nothing loops without waiting
+constexpr bool scriptCheck(const uint8_t* code, uint16_t size) {
+  if (!scriptWellFormed(code, size)) return false;
+  for (uint16_t pc = 0; pc < size; pc += scriptOpSize[code[pc]]) {
+    uint8_t op = code[pc];
+    if ((op == OP_IF_SENSOR || op == OP_JUMP) && scriptFindLabel(code, size, code[pc + 1]) < 0) return false;
+    if (op == OP_CHANCE && scriptFindLabel(code, size, code[pc + 2]) < 0) return false;
+  }
+  for (uint16_t pc = 0; pc < size; pc += scriptOpSize[code[pc]]) {
+    if (scriptBurst(code, size, pc) > SCRIPT_MAX_STEPS) return false;
+  }
+  return true;
+}
+
+#define SCRIPT_CHECK(script) \
+  static_assert(scriptCheck(script, sizeof(script)), \
+                #script ": unknown/duplicate jump label, no S_END, or no wait within SCRIPT_MAX_STEPS")
+
+#endif
@@ -0,0 +1,30 @@
+// ============================================================================
+// CROW RANDOM NUMBERS
+// ============================================================================
+// Every random choice the crow makes (idle timing, blinks, script branches)
+// comes from this one xorshift32 generator instead of the core's random(), so
+// the session recorder can checkpoint its 4-byte state and the host replay
+// tool can pick up from it.
+#ifndef CROW_RANDOM_H
+#define CROW_RANDOM_H
+
+#include <Arduino.h>
+
+static uint32_t crowRandomState = 1;
+
+void crowRandomSeed(uint32_t seed) {
+  crowRandomState = seed != 0 ? seed : 1;  // xorshift never leaves zero
+}
+
+// provides a number in [howSmall, howBig), like random()
+long crowRandom(long howSmall, long howBig) {
+  if (howSmall >= howBig) return howSmall;
+  uint32_t x = crowRandomState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  crowRandomState = x;
+  return howSmall + (long)(x % (uint32_t)(howBig - howSmall));
+}
+
+#endif
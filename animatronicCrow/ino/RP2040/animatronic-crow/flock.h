@@ -0,0 +1,285 @@
+// ============================================================================
+// FLOCK BUS v1.0
+// ============================================================================
+// Several crows share one half-duplex serial bus (RS-485 transceivers on a
+// spare UART). Node 0 is the leader: it owns the bus clock and decides who
+// scolds and who turns its head. Every other node is a follower.
+//
+// Every frame is 6 bytes:  SYNC | SRC | TYPE | ARG0 | ARG1 | CRC8
+//
+// The bus runs in fixed cycles of FLOCK_CYCLE_MS. The leader opens each cycle
+// with a BEACON (plus at most one WAVE) in slot 0; follower N may only send in
+// slot N, so a cycle carries at most FLOCK_NODE_COUNT + 1 frames and a sensor
+// event reaches the leader within one cycle.
+//
+// A SENSOR frame lost to a collision or noise is sent again next cycle (up to
+// FLOCK_SENSOR_SENDS times) until the leader's WAVE shows it was heard. A
+// repeat from the origin of the wave in progress means the origin missed the
+// WAVE, so the leader sends the same WAVE again (see flockQueueWave()).
+//
+// A WAVE names the origin node: the origin scolds immediately and every other
+// node turns toward it after |id - origin| * step ms. All nodes hear the same
+// frame at the same time, so no clock synchronization is needed.
+#ifndef FLOCK_H
+#define FLOCK_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+#if FLOCK_MODE != FLOCK_MODE_OFF
+#if FLOCK_NODE_COUNT * FLOCK_SLOT_MS > FLOCK_CYCLE_MS
+#error "FLOCK_NODE_COUNT slots of FLOCK_SLOT_MS do not fit in FLOCK_CYCLE_MS"
+#endif
+#if SENSOR_MODE == SENSOR_MODE_BUTTON
+#error "FLOCK_MODE is not supported with SENSOR_MODE_BUTTON"
+#endif
+#if (FLOCK_MODE == FLOCK_MODE_LEADER) != (FLOCK_NODE_ID == 0)
+#error "The flock leader must be FLOCK_NODE_ID 0 (and only the leader)"
+#endif
+#endif
+
+#define FLOCK_SYNC_BYTE     0x7E
+#define FLOCK_FRAME_LEN     6
+#define FLOCK_SENSOR_SENDS  3  // SENSOR frames sent while no WAVE is heard
+
+enum FlockMsgType : uint8_t {
+  FLOCK_MSG_BEACON = 1, // leader: start of cycle, arg0 = cycle counter
+  FLOCK_MSG_SENSOR = 2, // follower: motion detected
+  FLOCK_MSG_WAVE   = 3  // leader: arg0 = origin node, arg1 = step (10ms units)
+};
+
+enum FlockAction : uint8_t {
+  FLOCK_ACTION_NONE,
+  FLOCK_ACTION_SCOLD,     // this node is the wave origin
+  FLOCK_ACTION_TURN_DOWN, // turn toward lower node ids
+  FLOCK_ACTION_TURN_UP    // turn toward higher node ids
+};
+
+struct FlockFrame {
+  uint8_t src;
+  uint8_t type;
+  uint8_t arg0;
+  uint8_t arg1;
+};
+
+// Everything one node knows about the bus. The sketch owns a single node;
+// the host tests run several on one simulated bus.
+struct FlockNode {
+  // Identity
+  uint8_t id;
+  bool leader;
+  Stream* bus;
+
+  // Receiver
+  uint8_t rxBuf[FLOCK_FRAME_LEN];
+  uint8_t rxLen;
+
+  // Bus clock (the leader counts cycles, followers copy them from the beacon)
+  uint8_t cycle;
+  bool haveBeacon;
+  unsigned long lastBeaconTime;
+
+  // Sensor report
+  bool sensorHigh;          // last level seen, so only a rising edge is reported
+  uint8_t sensorSends;      // SENSOR frames left to send until a WAVE is heard
+  int16_t sensorSentCycle;  // one SENSOR frame per cycle
+
+  // Last wave (the leader's sent, a follower's applied)
+  int16_t pendingOrigin;    // leader: wave to send next cycle
+  bool pendingRepeat;       // leader: it is the last wave again, for an origin that missed it
+  uint8_t lastWaveOrigin;
+  unsigned long lastWaveTime;
+  unsigned long sensorsBlocked; // leader: SENSOR frames dropped during another origin's block
+
+  // Scheduled local action
+  uint8_t pendingAction;
+  unsigned long actionTime;
+
+  // Counters
+  unsigned long framesTx;
+  unsigned long framesRx;
+  unsigned long crcErrors;
+};
+
+// CRC-8 (poly 0x07) over SRC..ARG1
+uint8_t flockCrc8(const uint8_t* data, uint8_t len) {
+  uint8_t crc = 0;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+}
+
+void flockBegin(FlockNode& node, uint8_t id, Stream& bus) {
+  node = FlockNode();
+  node.id = id;
+  node.leader = (id == 0);
+  node.bus = &bus;
+  node.sensorSentCycle = -1;
+  node.pendingOrigin = -1;
+  if (PIN_FLOCK_DE >= 0) {
+    pinMode(PIN_FLOCK_DE, OUTPUT);
+    digitalWrite(PIN_FLOCK_DE, LOW); // listen
+  }
+}
+
+void flockSend(FlockNode& node, uint8_t type, uint8_t arg0, uint8_t arg1) {
+  uint8_t frame[FLOCK_FRAME_LEN] = {FLOCK_SYNC_BYTE, node.id, type, arg0, arg1, 0};
+  frame[5] = flockCrc8(&frame[1], 4);
+
+  if (PIN_FLOCK_DE >= 0) digitalWrite(PIN_FLOCK_DE, HIGH);
+  node.bus->write(frame, FLOCK_FRAME_LEN);
+  if (PIN_FLOCK_DE >= 0) {
+    node.bus->flush(); // ~1ms at 57600 baud, hold the driver until the last bit
+    digitalWrite(PIN_FLOCK_DE, LOW);
+  }
+  node.framesTx++;
+}
+
+// reads available bytes and provides the next valid frame, if any
+bool flockReceive(FlockNode& node, FlockFrame& frame) {
+  while (node.bus->available() > 0) {
+    uint8_t b = node.bus->read();
+    if (node.rxLen == 0 && b != FLOCK_SYNC_BYTE) continue; // resync
+    node.rxBuf[node.rxLen++] = b;
+    if (node.rxLen < FLOCK_FRAME_LEN) continue;
+
+    node.rxLen = 0;
+    if (flockCrc8(&node.rxBuf[1], 4) != node.rxBuf[5]) {
+      node.crcErrors++;
+      // A collision or a truncated frame: the next frame may already start
+      // inside this one, so resync on its first SYNC byte
+      for (uint8_t i = 1; i < FLOCK_FRAME_LEN; i++) {
+        if (node.rxBuf[i] != FLOCK_SYNC_BYTE) continue;
+        node.rxLen = FLOCK_FRAME_LEN - i;
+        memmove(node.rxBuf, &node.rxBuf[i], node.rxLen);
+        break;
+      }
+      continue;
+    }
+    frame.src = node.rxBuf[1];
+    frame.type = node.rxBuf[2];
+    frame.arg0 = node.rxBuf[3];
+    frame.arg1 = node.rxBuf[4];
+    node.framesRx++;
+    return true;
+  }
+  return false;
+}
+
+// schedules this node's part of a wave started at the origin node
+void flockApplyWave(FlockNode& node, uint8_t origin, uint8_t step10ms, unsigned long now) {
+  if (origin == node.id) {
+    node.pendingAction = FLOCK_ACTION_SCOLD;
+    node.actionTime = now;
+    return;
+  }
+  uint8_t distance = origin < node.id ? node.id - origin : origin - node.id;
+  node.pendingAction = origin < node.id ? FLOCK_ACTION_TURN_DOWN : FLOCK_ACTION_TURN_UP;
+  node.actionTime = now + (unsigned long)distance * step10ms * 10;
+}
+
+// leader: queue a wave for the next cycle unless one is already due or blocked.
+// The block is flock-wide, as a lone crow blocks scolds after a scold: for
+// SCOLD_SQUAWK_BLOCK_MS after a wave, motion at any other crow is dropped
+// (counted in sensorsBlocked) rather than starting a second wave over the
+// first. The trade-off is that a second visitor at another crow within the
+// block gets no scold. A SENSOR from the wave's own origin during the block
+// means it missed the WAVE: the same WAVE goes out again, and the block is
+// not restarted.
+void flockQueueWave(FlockNode& node, uint8_t origin, unsigned long now) {
+  if (origin >= FLOCK_NODE_COUNT || node.pendingOrigin >= 0) return;
+  if (node.lastWaveTime != 0 && now - node.lastWaveTime < SCOLD_SQUAWK_BLOCK_MS) {
+    if (origin == node.lastWaveOrigin && origin != node.id) {
+      node.pendingOrigin = origin;
+      node.pendingRepeat = true;
+    } else {
+      node.sensorsBlocked++;
+    }
+    return;
+  }
+  node.pendingOrigin = origin;
+  node.pendingRepeat = false;
+  node.lastWaveOrigin = origin;
+  node.lastWaveTime = now;
+}
+
+// follower: true for a WAVE already acted on (sent again for an origin that
+// missed it)
+bool flockRepeatedWave(const FlockNode& node, uint8_t origin, unsigned long now) {
+  return node.lastWaveTime != 0 && origin == node.lastWaveOrigin && now - node.lastWaveTime < SCOLD_SQUAWK_BLOCK_MS;
+}
+
+// true when the leader is coordinating scolds (followers fall back to
+// standalone behavior if the beacon is lost)
+bool flockOnline(const FlockNode& node, unsigned long now) {
+  if (node.bus == nullptr) return false;
+  if (node.leader) return true;
+  return node.haveBeacon && now - node.lastBeaconTime < FLOCK_LEADER_TIMEOUT_MS;
+}
+
+// reports local motion to the leader on its rising edge only. A follower
+// sends SENSOR in its slot, once per cycle, until a WAVE shows the leader
+// heard it (a frame lost to a collision or noise is sent again).
+void flockSensor(FlockNode& node, bool high, unsigned long now) {
+  bool rising = high && !node.sensorHigh;
+  node.sensorHigh = high;
+  if (!rising) return;
+  if (node.leader) flockQueueWave(node, node.id, now);
+  else node.sensorSends = FLOCK_SENSOR_SENDS;
+}
+
+// services the bus and provides the local action that is now due, if any
+uint8_t flockUpdate(FlockNode& node, unsigned long now) {
+  if (node.bus == nullptr) return FLOCK_ACTION_NONE;
+
+  FlockFrame frame;
+  while (flockReceive(node, frame)) {
+    if (node.leader) {
+      if (frame.type == FLOCK_MSG_SENSOR) flockQueueWave(node, frame.src, now);
+    } else if (frame.src == 0) {
+      if (frame.type == FLOCK_MSG_BEACON) {
+        node.haveBeacon = true;
+        node.lastBeaconTime = now;
+        node.cycle = frame.arg0;
+      } else if (frame.type == FLOCK_MSG_WAVE) {
+        node.sensorSends = 0;
+        if (!flockRepeatedWave(node, frame.arg0, now)) {
+          node.lastWaveOrigin = frame.arg0;
+          node.lastWaveTime = now;
+          flockApplyWave(node, frame.arg0, frame.arg1, now);
+        }
+      }
+    }
+  }
+
+  if (node.leader) {
+    if (now - node.lastBeaconTime >= FLOCK_CYCLE_MS) {
+      node.lastBeaconTime = now;
+      flockSend(node, FLOCK_MSG_BEACON, node.cycle++, 0);
+      if (node.pendingOrigin >= 0) {
+        flockSend(node, FLOCK_MSG_WAVE, node.pendingOrigin, FLOCK_WAVE_STEP_MS / 10);
+        if (!node.pendingRepeat) flockApplyWave(node, node.pendingOrigin, FLOCK_WAVE_STEP_MS / 10, now);
+        node.pendingOrigin = -1;
+      }
+    }
+  } else if (node.sensorSends > 0 && node.sensorSentCycle != node.cycle && flockOnline(node, now)) {
+    unsigned long slotStart = (unsigned long)node.id * FLOCK_SLOT_MS;
+    unsigned long sinceBeacon = now - node.lastBeaconTime;
+    if (sinceBeacon >= slotStart && sinceBeacon < slotStart + FLOCK_SLOT_MS) {
+      flockSend(node, FLOCK_MSG_SENSOR, 0, 0);
+      node.sensorSends--;
+      node.sensorSentCycle = node.cycle;
+    }
+  }
+
+  if (node.pendingAction != FLOCK_ACTION_NONE && (long)(now - node.actionTime) >= 0) {
+    uint8_t action = node.pendingAction;
+    node.pendingAction = FLOCK_ACTION_NONE;
+    return action;
+  }
+  return FLOCK_ACTION_NONE;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,189 @@
+// ============================================================================
+// HEALTH MONITOR
+// ============================================================================
+// Both cores beat a heartbeat every loop. Core0 feeds the hardware watchdog
+// only while Core1's heartbeat is fresh and no reboot has been asked for, so
+// a wedged core (either one) reboots the board within HEALTH_WDT_MS. The
+// sketch checks its own state (stuck modes, stalled animations, a silent
+// DFPlayer) and recovers in place; healthReboot() is its last resort.
+//
+// Fault counters live in RAM the runtime does not clear, so they survive a
+// watchdog reboot (but not a power cycle). A watchdog reboot sets
+// healthQuickStart so setup() can skip the cosmetic startup sequence. A
+// reboot the sketch asked for counts as FAULT_REBOOT, not FAULT_WATCHDOG, so
+// the watchdog counter only shows cores that stopped on their own.
+//
+// Either core can record a fault, but only the crow's core (Core1 with
+// CORE_SPLIT) writes to Serial: healthLog() prints the faults recorded since
+// its last call, so Core0's output never interleaves with the crow's.
+#ifndef HEALTH_H
+#define HEALTH_H
+
+#include <Arduino.h>
+#include <hardware/watchdog.h>
+#include "settings.h"
+
+#if HEALTH_WATCHDOG
+#if HEALTH_WDT_MS > 8300
+#error "HEALTH_WDT_MS is longer than the RP2040 watchdog allows (8300ms)"
+#endif
+#if HEALTH_WDT_MS <= POWER_MAX_SLEEP_MS || HEALTH_WDT_MS <= HEALTH_CORE_TIMEOUT_MS
+#error "HEALTH_WDT_MS must be longer than POWER_MAX_SLEEP_MS and HEALTH_CORE_TIMEOUT_MS"
+#endif
+#endif
+
+#define HEALTH_MAGIC          0xC40BEA76
+
+enum HealthFault : uint8_t {
+  FAULT_WATCHDOG,     // board rebooted by the watchdog (not asked for)
+  FAULT_REBOOT,       // the sketch asked for a reboot (healthReboot())
+  FAULT_CORE1_STALL,  // Core1's heartbeat stopped
+  FAULT_MODE_STUCK,   // a mode outlived HEALTH_MODE_TIMEOUT_MS
+  FAULT_ANIM_STALL,   // a beak animation ran past its end
+  FAULT_DFPLAYER,     // DFPlayer stopped answering
+  FAULT_COUNT
+};
+
+struct HealthRecord {
+  uint32_t magic;
+  uint32_t boots;
+  uint16_t faults[FAULT_COUNT];
+  uint8_t lastFault;  // FAULT_COUNT: none
+  bool rebootAsked;   // healthReboot() ran before this boot
+  uint32_t check;
+};
+
+// Fault Record (not zeroed at boot)
+static HealthRecord healthRecord __attribute__((section(".uninitialized_data.healthRecord")));
+
+// Heartbeats (one per core)
+static volatile uint32_t healthBeats[2];
+
+// Watchdog State (Core0)
+static bool healthWatchCore1 = false;
+static uint32_t healthSeenBeat = 0;
+static unsigned long healthSeenTime = 0;
+static volatile bool healthRebooting = false;
+static bool healthQuickStart = false;
+
+// Fault Log (the crow's core)
+static uint16_t healthLogged[FAULT_COUNT];  // fault counts already printed
+static bool healthLoggedReboot = false;
+
+uint32_t healthChecksum() {
+  uint32_t sum = healthRecord.magic ^ healthRecord.boots ^ healthRecord.lastFault ^ (uint32_t)healthRecord.rebootAsked << 8;
+  for (uint8_t i = 0; i < FAULT_COUNT; i++) sum = (sum << 3 | sum >> 29) ^ healthRecord.faults[i];
+  return sum;
+}
+
+const char* healthFaultName(uint8_t fault) {
+  switch (fault) {
+    case FAULT_WATCHDOG:    return "watchdog";
+    case FAULT_REBOOT:      return "reboot";
+    case FAULT_CORE1_STALL: return "Core1 stall";
+    case FAULT_MODE_STUCK:  return "stuck mode";
+    case FAULT_ANIM_STALL:  return "stalled animation";
+    case FAULT_DFPLAYER:    return "DFPlayer";
+  }
+  return "none";
+}
+
+void healthFault(uint8_t fault) {
+  if (healthRecord.faults[fault] < 0xFFFF) healthRecord.faults[fault]++;
+  if (fault != FAULT_WATCHDOG && fault != FAULT_REBOOT) healthRecord.lastFault = fault;  // the cause, not the reboot
+  healthRecord.check = healthChecksum();
+}
+
+// prints the faults recorded since the last call; call from the crow's loop
+void healthLog() {
+  for (uint8_t i = 0; i < FAULT_COUNT; i++) {
+    uint16_t count = healthRecord.faults[i];
+    if (count == healthLogged[i]) continue;
+    healthLogged[i] = count;
+    Serial.print(F("[Health] ✗ Fault: "));
+    Serial.print(healthFaultName(i));
+    Serial.print(F(" (#"));
+    Serial.print(count);
+    Serial.println(F(")"));
+  }
+  if (healthRebooting && !healthLoggedReboot) {
+    healthLoggedReboot = true;
+    Serial.println(F("[Health] Rebooting through the watchdog"));
+  }
+}
+
+// loads (or starts) the fault record; call first thing in setup()
+void healthBegin() {
+  if (healthRecord.magic != HEALTH_MAGIC || healthRecord.check != healthChecksum()) {
+    memset(&healthRecord, 0, sizeof(healthRecord));
+    healthRecord.magic = HEALTH_MAGIC;
+    healthRecord.lastFault = FAULT_COUNT;
+  }
+  healthRecord.boots++;
+  healthRecord.check = healthChecksum();
+  memcpy(healthLogged, healthRecord.faults, sizeof(healthLogged));
+  healthLoggedReboot = false;
+  healthQuickStart = HEALTH_WATCHDOG && HEALTH_QUICK_RESTART && watchdog_enable_caused_reboot();
+}
+
+// starts the watchdog; call at the end of setup()
+void healthStart(bool watchCore1) {
+  if (watchdog_enable_caused_reboot() && !healthRecord.rebootAsked) healthFault(FAULT_WATCHDOG);
+  healthRecord.rebootAsked = false;
+  healthRecord.check = healthChecksum();
+  healthWatchCore1 = watchCore1 && HEALTH_WATCHDOG;
+  healthSeenTime = millis();
+  if (HEALTH_WATCHDOG) rp2040.wdt_begin(HEALTH_WDT_MS);
+}
+
+void healthBeat(uint8_t core) {
+  healthBeats[core] = healthBeats[core] + 1;
+}
+
+// asks Core0 to stop feeding the watchdog
+void healthReboot() {
+  if (healthRebooting) return;
+  healthFault(FAULT_REBOOT);
+  healthRecord.rebootAsked = true;
+  healthRecord.check = healthChecksum();
+  healthRebooting = true;
+  if (!HEALTH_WATCHDOG) rp2040.reboot();
+}
+
+// Core0, every loop: beats and feeds the watchdog while Core1 keeps beating
+void healthWatch(unsigned long now) {
+  healthBeat(0);
+  if (healthRebooting) return;
+
+  if (healthWatchCore1) {
+    uint32_t beat = healthBeats[1];
+    if (beat != healthSeenBeat) {
+      healthSeenBeat = beat;
+      healthSeenTime = now;
+    } else if (now - healthSeenTime >= HEALTH_CORE_TIMEOUT_MS) {
+      healthFault(FAULT_CORE1_STALL);
+      healthReboot();
+      return;
+    }
+  }
+  if (HEALTH_WATCHDOG) rp2040.wdt_reset();
+}
+
+void healthReport() {
+  Serial.print(F("[Health] Boots "));
+  Serial.print(healthRecord.boots);
+  for (uint8_t i = 0; i < FAULT_COUNT; i++) {
+    Serial.print(F(", "));
+    Serial.print(healthFaultName(i));
+    Serial.print(F(" "));
+    Serial.print(healthRecord.faults[i]);
+  }
+  Serial.print(F(", last fault: "));
+  Serial.print(healthFaultName(healthRecord.lastFault));
+  Serial.print(F(", heartbeats "));
+  Serial.print(healthBeats[0]);
+  Serial.print(F("/"));
+  Serial.println(healthBeats[1]);
+}
+
+#endif
@@ -0,0 +1,43 @@
+// ============================================================================
+// MEMORY BUDGET
+// ============================================================================
+// Checks what is known at compile time against the MEMORY_* budgets in
+// settings.h: the animation tables (index and every keyframe) and the RAM
+// tables the crow keeps. The firmware's flash and static RAM totals are only
+// known once linked; crow-host/memory-budget.py checks them after the build
+// and breaks them down by subsystem (see BUILD.md), so none of this costs
+// the crow anything at run time.
+//
+// Size model: every animation costs sizeof(SoundAnimation) plus
+// sizeof(AnimKeyFrame) per keyframe of flash (12 + 4 per keyframe on the
+// RP2040), and no RAM.
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <Arduino.h>
+#include "settings.h"
+#include "animations.h"
+#include "recorder.h"
+#include "health.h"
+#include "motion.h"
+
+#define NUM_ANIMATIONS_MAX    255   // tracks are numbered with a uint8_t
+
+// keyframes in soundAnimations[i] and every animation after it
+constexpr unsigned long memoryKeyframes(uint8_t i = 0) {
+  return i < NUM_ANIMATIONS ? soundAnimations[i].numKeyframes + memoryKeyframes(i + 1) : 0;
+}
+
+constexpr unsigned long memoryAnimationBytes = sizeof(soundAnimations) + memoryKeyframes() * sizeof(AnimKeyFrame);
+
+constexpr unsigned long memoryRecorderBytes = sizeof(recordInputLog) + sizeof(recordOutputLog) +
+                                              sizeof(recordCheckpoints) + sizeof(recordSlow);
+
+static_assert(sizeof(easingLUT) + memoryRecorderBytes + sizeof(healthRecord) + sizeof(motionBox) <= MEMORY_RAM_BUDGET_KB * 1024UL,
+              "Crow RAM tables alone exceed MEMORY_RAM_BUDGET_KB");
+static_assert(memoryAnimationBytes <= MEMORY_ANIM_BUDGET_BYTES,
+              "The animation tables (index and keyframes) exceed MEMORY_ANIM_BUDGET_BYTES");
+static_assert(sizeof(soundAnimations) / sizeof(SoundAnimation) <= NUM_ANIMATIONS_MAX,
+              "Too many animations for uint8_t track numbers");
+
+#endif
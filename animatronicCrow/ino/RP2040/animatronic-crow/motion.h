@@ -0,0 +1,286 @@
+// ============================================================================
+// MOTION CORE
+// ============================================================================
+// With CORE_SPLIT, Core1 runs the crow (sensors, behavior, beak animation,
+// audio) and Core0 runs nothing but motionLoop(): stepper.run(), the beak
+// servo writes and the neck coils. Neck and beak commands cross between the
+// cores through a mailbox that neither side ever waits on:
+//
+// - Core1 stages each command and posts the whole setpoint under a sequence
+//   number (odd while it is being written).
+// - Core0 copies the setpoint when the number is new and even, and drops the
+//   copy if the number moved meanwhile (it takes it on its next loop).
+// - Core0 publishes the neck's distance to go and the last command applied,
+//   so Core1 never sees a finished move before its new command has started.
+//
+// While the neck is still and no setpoint is waiting, Core0 waits for an
+// event (WFE) instead of spinning: Core1 sends one (SEV) with every post, and
+// the wait ends after MOTION_IDLE_WAKE_MS regardless so the watchdog is fed
+// and the coils are released on time.
+//
+// Without CORE_SPLIT (or before motionBegin()) the same functions drive the
+// stepper directly. Either way the time between stepper.run() calls while
+// the neck moves is measured and logged every MOTION_REPORT_MS, so the two
+// layouts can be compared on the same crow.
+#ifndef MOTION_H
+#define MOTION_H
+
+#include <Arduino.h>
+#include <AccelStepper.h>
+#include <hardware/sync.h>
+#include <pico/time.h>
+#include "settings.h"
+#include "crow-utils.h"
+#include "power.h"
+
+extern AccelStepper stepper;
+
+#define MOTION_IDLE_WAKE_MS   50    // longest wait for a setpoint while the neck is still
+
+struct MotionSetpoint {
+  uint32_t neckSeq;     // bumped by every neck command
+  long neckTarget;
+  uint16_t neckMaxSpeed;
+  uint16_t neckAccel;
+  bool neckStop;        // stop() instead of moveTo(neckTarget)
+  int beakPWM;          // -1 releases the servo
+};
+
+struct MotionStats {
+  unsigned long loops;     // stepper.run() calls while the neck moved
+  unsigned long meanUs;    // time between them
+  unsigned long jitterUs;  // standard deviation
+  unsigned long maxUs;
+  unsigned long idlePercent; // of the window Core0 spent waiting for a setpoint
+};
+
+static volatile bool motionSplit = false;
+
+// Mailbox (Core1 to Core0)
+static volatile uint32_t motionBoxSeq = 0;
+static MotionSetpoint motionBox;
+static MotionSetpoint motionStaged = {0, 0, 0, 0, false, -1};  // Core1's copy
+static uint32_t motionTakenSeq = 0;                              // Core0's last copy
+static uint32_t motionAppliedNeckSeq = 0;
+
+// Neck Status (Core0 to Core1)
+static volatile long motionNeckDistance = 0;
+static volatile uint32_t motionNeckSeq = 0;
+
+// Loop Timing (kept by the core that runs the stepper)
+static unsigned long motionLastRunUs = 0;
+static bool motionWasMoving = false;
+static unsigned long motionWindowStart = 0;
+static unsigned long motionLoops = 0;
+static unsigned long long motionSumUs = 0;
+static unsigned long long motionSumSqUs = 0;
+static unsigned long motionMaxUs = 0;
+static unsigned long long motionIdleUs = 0;
+
+// Stats (published by the stepper core once per MOTION_REPORT_MS)
+static volatile uint32_t motionStatsSeq = 0;
+static MotionStats motionStats;
+
+// hands the stepper to Core0's motionLoop(); call at the end of setup()
+void motionBegin() {
+  motionSplit = CORE_SPLIT;
+  motionWindowStart = millis();
+}
+
+// ============================================================================
+// CORE1 SIDE (or the only core)
+// ============================================================================
+
+void motionPost() {
+  motionBoxSeq = motionBoxSeq + 1; // odd: being written
+  __dmb();
+  motionBox = motionStaged;
+  __dmb();
+  motionBoxSeq = motionBoxSeq + 1;
+  __sev();  // ends Core0's wait in motionIdle()
+}
+
+// commands are always staged, so the first posted setpoint carries the speed
+// setup() left the neck at
+void motionNeckSpeed(uint16_t maxSpeed, uint16_t accel) {
+  motionStaged.neckMaxSpeed = maxSpeed;
+  motionStaged.neckAccel = accel;
+  if (!motionSplit) {
+    stepper.setMaxSpeed(maxSpeed);
+    stepper.setAcceleration(accel);
+    return;
+  }
+  motionStaged.neckSeq++;
+  motionPost();
+}
+
+void motionMoveNeck(long position) {
+  motionStaged.neckTarget = position;
+  motionStaged.neckStop = false;
+  if (!motionSplit) {
+    powerWakeNeck();
+    stepper.moveTo(position);
+    return;
+  }
+  motionStaged.neckSeq++;
+  motionPost();
+}
+
+void motionStopNeck() {
+  if (!motionSplit) {
+    stepper.stop();
+    return;
+  }
+  motionStaged.neckStop = true;
+  motionStaged.neckSeq++;
+  motionPost();
+}
+
+// true once the neck has finished the last command given
+bool motionNeckSettled() {
+  if (!motionSplit) return stepper.distanceToGo() == 0;
+  if (motionNeckSeq != motionStaged.neckSeq) return false;
+  __dmb();
+  return motionNeckDistance == 0;
+}
+
+// beak PWM from the animation (-1 when it is over)
+void motionBeak(int pwm) {
+  if (!motionSplit) {
+    writeBeak(pwm);
+    return;
+  }
+  if (pwm == motionStaged.beakPWM) return;
+  motionStaged.beakPWM = pwm;
+  motionPost();
+}
+
+// ============================================================================
+// STEPPER SIDE
+// ============================================================================
+
+// times stepper.run() calls while the neck moves; call right after run()
+void motionMeasure(unsigned long now, bool moving) {
+  unsigned long us = micros();
+  if (moving && motionWasMoving) {
+    unsigned long gap = us - motionLastRunUs;
+    motionLoops++;
+    motionSumUs += gap;
+    motionSumSqUs += (unsigned long long)gap * gap;
+    if (gap > motionMaxUs) motionMaxUs = gap;
+  }
+  motionLastRunUs = us;
+  motionWasMoving = moving;
+
+  if (MOTION_REPORT_MS == 0 || now - motionWindowStart < MOTION_REPORT_MS) return;
+  MotionStats s = {motionLoops, 0, 0, motionMaxUs, 0};
+  s.idlePercent = motionIdleUs / ((now - motionWindowStart) * 10 + 1);
+  if (motionLoops > 0) {
+    unsigned long long mean = motionSumUs / motionLoops;
+    unsigned long long meanSq = motionSumSqUs / motionLoops;
+    s.meanUs = mean;
+    s.jitterUs = meanSq > mean * mean ? sqrt((double)(meanSq - mean * mean)) : 0;
+  }
+  motionStatsSeq = motionStatsSeq + 1;
+  __dmb();
+  motionStats = s;
+  __dmb();
+  motionStatsSeq = motionStatsSeq + 1;
+
+  motionWindowStart = now;
+  motionLoops = 0;
+  motionSumUs = 0;
+  motionSumSqUs = 0;
+  motionMaxUs = 0;
+  motionIdleUs = 0;
+}
+
+// copies a new setpoint from the mailbox; false if there is none (yet)
+bool motionTake(MotionSetpoint& sp) {
+  uint32_t seq = motionBoxSeq;
+  if (seq == motionTakenSeq || (seq & 1)) return false;
+  __dmb();
+  sp = motionBox;
+  __dmb();
+  if (motionBoxSeq != seq) return false;
+  motionTakenSeq = seq;
+  return true;
+}
+
+// waits for Core1's next post; an event sent since motionTake() looked is
+// latched, so WFE returns at once and no setpoint waits for the timeout
+void motionIdle() {
+  unsigned long start = micros();
+  best_effort_wfe_or_timeout(make_timeout_time_ms(MOTION_IDLE_WAKE_MS));
+  motionIdleUs += micros() - start;
+}
+
+// Core0's loop when CORE_SPLIT
+void motionLoop() {
+  MotionSetpoint sp;
+  if (motionTake(sp)) {
+    if (sp.neckSeq != motionAppliedNeckSeq) {
+      stepper.setMaxSpeed(sp.neckMaxSpeed);
+      stepper.setAcceleration(sp.neckAccel);
+      if (sp.neckStop) {
+        stepper.stop();
+      } else {
+        powerWakeNeck();
+        stepper.moveTo(sp.neckTarget);
+      }
+      motionAppliedNeckSeq = sp.neckSeq;
+    }
+    writeBeak(sp.beakPWM);
+  }
+
+  stepper.run();
+  long distance = stepper.distanceToGo();
+  unsigned long now = millis();
+  motionMeasure(now, distance != 0);
+  powerUpdate(now, distance == 0);
+
+  motionNeckDistance = distance;
+  __dmb();
+  motionNeckSeq = motionAppliedNeckSeq;
+
+  if (POWER_IDLE_SLEEP && distance == 0 && stepper.speed() == 0) motionIdle();
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+// logs each new window of loop timing (call from the behavior loop)
+void motionReport() {
+  static uint32_t reportedSeq = 0;
+  uint32_t seq = motionStatsSeq;
+  if (seq == reportedSeq || (seq & 1)) return;
+  __dmb();
+  MotionStats s = motionStats;
+  __dmb();
+  if (motionStatsSeq != seq) return;
+  reportedSeq = seq;
+
+  Serial.print(motionSplit ? F("[Motion] Core0 (split) ") : F("[Motion] Core0 (shared) "));
+  if (motionSplit) {
+    Serial.print(F("idle "));
+    Serial.print(s.idlePercent);
+    Serial.print(F("%, "));
+  }
+  if (s.loops == 0) {
+    Serial.println(F("neck did not move"));
+    return;
+  }
+  Serial.print(1000000UL / (s.meanUs ? s.meanUs : 1));
+  Serial.print(F(" runs/s while moving, mean "));
+  Serial.print(s.meanUs);
+  Serial.print(F("us, jitter "));
+  Serial.print(s.jitterUs);
+  Serial.print(F("us, max "));
+  Serial.print(s.maxUs);
+  Serial.print(F("us over "));
+  Serial.print(s.loops);
+  Serial.println(F(" runs"));
+}
+
+#endif
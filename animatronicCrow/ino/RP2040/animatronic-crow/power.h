@@ -0,0 +1,198 @@
+// ============================================================================
+// POWER MANAGER
+// ============================================================================
+// Releases the neck stepper coils once the neck has settled and puts the core
+// running the crow (Core1 with CORE_SPLIT, else Core0) to sleep (WFI) until
+// the next scheduled event. A hardware alarm ends the sleep at the deadline;
+// an edge on the sensor pin ends it early, so trigger latency is unchanged.
+// Both interrupts fire on the core that set them up, so powerBegin() has to
+// run on the core that sleeps.
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+#include <AccelStepper.h>
+#include <hardware/sync.h>
+#include <pico/time.h>
+#include "settings.h"
+
+extern AccelStepper stepper;
+
+// Stay awake this long after a sensor wake so the sensor poll (Core1's,
+// without CORE_SPLIT) can publish the new state
+#define POWER_SENSOR_HOLD_MS 100
+
+// What the idle crow is waiting for (millis() times)
+struct PowerSchedule {
+  unsigned long nextBlinkTime;
+  unsigned long nextSquawkTime;
+  unsigned long nextMoveTime;
+  unsigned long lastAudioTime;     // squawks and scolds wait SCOLD_SQUAWK_BLOCK_MS after it
+  unsigned long lastMovementTime;  // LD1020 waits LD1020_ANIMATION_COOLDOWN_MS after it
+  bool ld1020;                     // apply the LD1020 cooldown
+  bool blinking;                   // false in TEST_MODE (the eyes follow the sensor)
+  bool flock;                      // service the flock bus every FLOCK_SLOT_MS
+};
+
+// Power State
+static alarm_pool_t* powerAlarmPool = nullptr;
+static bool powerCoilsOn = true;
+static unsigned long powerSettledTime = 0;
+static volatile bool powerAlarmDue = false;
+static volatile bool powerEdge = false;      // a sensor edge the sleep has not seen yet
+static volatile unsigned long powerEdgeMicros = 0;
+static bool powerSensorSeen = false;
+static unsigned long powerSensorWakeTime = 0;
+
+// Counters
+static unsigned long powerCoilOnMs = 0;      // time with the coils energized
+static unsigned long powerCoilOnSince = 0;
+static unsigned long powerSleepMs = 0;       // time the crow's core spent asleep
+static unsigned long powerSleepCount = 0;
+static unsigned long powerSensorWakes = 0;   // sleeps ended by the sensor
+static unsigned long powerWakeLatencyUs = 0; // last sensor edge to loop() resuming
+static unsigned long powerWakeLatencyMaxUs = 0;
+
+int64_t powerAlarm(alarm_id_t id, void* data) {
+  powerAlarmDue = true;
+  return 0;
+}
+
+void powerSensorEdge() {
+  if (!powerEdge) powerEdgeMicros = micros();
+  powerEdge = true;
+}
+
+// call on the core that sleeps
+void powerBegin(bool wakeOnSensor) {
+  powerCoilOnSince = millis();
+  if (!POWER_IDLE_SLEEP) return;
+  powerAlarmPool = alarm_pool_create_with_unused_hardware_alarm(2);
+  if (wakeOnSensor) {
+    attachInterrupt(digitalPinToInterrupt(PIN_MOTION_SENSOR), powerSensorEdge, CHANGE);
+  }
+}
+
+// energize the coils before the next move
+void powerWakeNeck() {
+  if (powerCoilsOn) return;
+  stepper.enableOutputs();
+  powerCoilsOn = true;
+  powerCoilOnSince = millis();
+}
+
+// release the coils once the neck has been still for POWER_COIL_RELEASE_MS
+void powerUpdate(unsigned long now, bool neckSettled) {
+  if (!neckSettled) {
+    powerWakeNeck(); // in case a move started without powerWakeNeck()
+    powerSettledTime = now;
+    return;
+  }
+  if (POWER_RELEASE_COILS && powerCoilsOn && now - powerSettledTime >= POWER_COIL_RELEASE_MS) {
+    stepper.disableOutputs();
+    powerCoilsOn = false;
+    powerCoilOnMs += now - powerCoilOnSince;
+  }
+}
+
+// provides whichever of a and b comes first after now
+unsigned long powerEarliest(unsigned long now, unsigned long a, unsigned long b) {
+  return (long)(a - now) <= (long)(b - now) ? a : b;
+}
+
+// provides when the idle crow next has something to do
+unsigned long powerIdleDeadline(unsigned long now, const PowerSchedule& s) {
+  unsigned long deadline = s.blinking ? s.nextBlinkTime : now + POWER_MAX_SLEEP_MS;
+
+  // Squawks and scolds wait for the squawk block; LD1020 waits for its cooldown
+  unsigned long unblockTime = s.lastAudioTime + SCOLD_SQUAWK_BLOCK_MS;
+  unsigned long squawkTime = s.nextSquawkTime;
+  if ((long)(unblockTime - squawkTime) > 0) squawkTime = unblockTime;
+  unsigned long moveTime = s.nextMoveTime;
+  if (s.ld1020) {
+    unsigned long cooldownEnd = s.lastMovementTime + LD1020_ANIMATION_COOLDOWN_MS;
+    if ((long)(cooldownEnd - moveTime) > 0) moveTime = cooldownEnd;
+    if ((long)(cooldownEnd - squawkTime) > 0) squawkTime = cooldownEnd;
+  }
+  deadline = powerEarliest(now, deadline, squawkTime);
+  deadline = powerEarliest(now, deadline, moveTime);
+
+  // Keep servicing the flock bus every slot
+  if (s.flock) deadline = powerEarliest(now, deadline, now + FLOCK_SLOT_MS);
+  return deadline;
+}
+
+// provides how long to sleep before the deadline: 0 when it is too close or
+// the crow just woke for the sensor (holding), at most POWER_MAX_SLEEP_MS
+long powerSleepLength(unsigned long now, unsigned long deadline, bool holding) {
+  long sleepMs = (long)(deadline - now);
+  if (sleepMs < POWER_MIN_SLEEP_MS || holding) return 0;
+  return sleepMs > POWER_MAX_SLEEP_MS ? POWER_MAX_SLEEP_MS : sleepMs;
+}
+
+// sleeps until the deadline (capped at POWER_MAX_SLEEP_MS) or a sensor edge
+void powerSleepUntil(unsigned long now, unsigned long deadline) {
+  if (!POWER_IDLE_SLEEP || powerAlarmPool == nullptr) return;
+  // an edge that came in while awake (after the last poll) holds like a wake
+  if (powerEdge) {
+    powerEdge = false;
+    powerSensorSeen = true;
+    powerSensorWakeTime = now;
+  }
+  bool holding = powerSensorSeen && now - powerSensorWakeTime < POWER_SENSOR_HOLD_MS;
+  long sleepMs = powerSleepLength(now, deadline, holding);
+  if (sleepMs == 0) return;
+
+  // an edge from here on is left set in powerEdge, so it cannot be missed
+  powerAlarmDue = false;
+  alarm_id_t alarm = alarm_pool_add_alarm_in_ms(powerAlarmPool, sleepMs, powerAlarm, nullptr, true);
+  if (alarm <= 0) return;
+
+  // interrupts stay masked between the check and WFI so a wake cannot be missed
+  while (true) {
+    uint32_t status = save_and_disable_interrupts();
+    if (powerAlarmDue || powerEdge) {
+      restore_interrupts(status);
+      break;
+    }
+    __wfi();
+    restore_interrupts(status);
+  }
+  alarm_pool_cancel_alarm(powerAlarmPool, alarm);
+
+  powerSleepMs += millis() - now;
+  powerSleepCount++;
+  if (powerEdge) {
+    powerEdge = false;
+    powerSensorWakes++;
+    powerSensorSeen = true;
+    powerSensorWakeTime = millis();
+    powerWakeLatencyUs = micros() - powerEdgeMicros;
+    if (powerWakeLatencyUs > powerWakeLatencyMaxUs) powerWakeLatencyMaxUs = powerWakeLatencyUs;
+  }
+}
+
+// periodic summary of the power counters
+void powerReport(unsigned long now) {
+  static unsigned long lastReport = 0;
+  if (POWER_REPORT_MS == 0 || now - lastReport < POWER_REPORT_MS) return;
+
+  unsigned long coilMs = powerCoilOnMs + (powerCoilsOn ? now - powerCoilOnSince : 0);
+  unsigned long onePercent = now / 100 + 1;
+  Serial.print(F("[Power]  Coils on "));
+  Serial.print(coilMs / onePercent);
+  Serial.print(F("%, asleep "));
+  Serial.print(powerSleepMs / onePercent);
+  Serial.print(F("%, sleeps "));
+  Serial.print(powerSleepCount);
+  Serial.print(F(", sensor wakes "));
+  Serial.print(powerSensorWakes);
+  Serial.print(F(", wake latency "));
+  Serial.print(powerWakeLatencyUs);
+  Serial.print(F("us (max "));
+  Serial.print(powerWakeLatencyMaxUs);
+  Serial.println(F("us)"));
+  lastReport = now;
+}
+
+#endif
@@ -0,0 +1,313 @@
+// ============================================================================
+// SESSION RECORDER
+// ============================================================================
+// Keeps what is needed to replay the crow's behavior on a PC, each in its own
+// log so one kind of event never pushes out another:
+//   - inputs: sensor/button edges as the behavior loop saw them
+//   - outputs: mode transitions and tracks played (what a replay is checked
+//     against; in SENSOR_MODE_BUTTON the crow stays idle and only plays)
+//   - checkpoints: the random generator and the crow's timers, taken while the
+//     crow is at rest (at boot, every RECORD_CHECKPOINT_MS, and whenever half
+//     the input log has been written since the last one)
+//   - slow loops: counters and the last few slow loops (diagnostics only)
+// Send 'r' on the Serial Monitor to dump it as text. crow-host/crow-replay
+// restores the oldest checkpoint whose inputs are all still in the log, feeds
+// the inputs back at their recorded times and reports the first transition
+// that differs. The logs wrap, but a usable checkpoint always survives them.
+//
+// Times are ms since the end of setup().
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <Arduino.h>
+#include "settings.h"
+
+#define RECORD_MAX_MODES      8
+#define RECORD_SLOW_KEPT      16    // slow loops kept for the dump
+
+enum RecordType : uint8_t {
+  REC_SENSOR = 1, // arg = sensor level
+  REC_BUTTON = 2, // button trigger
+  REC_MODE   = 3, // arg = new mode, value = old mode
+  REC_TRACK  = 4  // arg = track
+};
+
+struct RecordEvent {
+  uint32_t timeMs;
+  uint8_t type;
+  uint8_t arg;
+  uint16_t value;
+};
+
+// The crow's state at rest: enough for the sketch to carry on from here
+struct RecordState {
+  uint32_t random;                // crowRandomState
+  int32_t nextMoveMs;             // times are relative, see recordTime()
+  int32_t nextSquawkMs;
+  int32_t nextBlinkMs;
+  int32_t lastAudioMs;
+  int32_t movementStartMs;
+  int32_t movementEndMs;
+  int32_t neckPosition;
+  uint8_t mode;
+  uint8_t eyesOpen;
+  uint8_t sensor;
+  uint8_t button;
+};
+
+struct RecordCheckpoint {
+  uint32_t timeMs;
+  uint32_t inputs;                // inputs logged before it
+  uint32_t outputs;               // outputs logged before it
+  RecordState state;
+};
+
+struct RecordSlow {
+  uint32_t timeMs;
+  uint32_t us;
+};
+
+// Hooks (provided by the sketch)
+void recordSnapshot(RecordState& s);
+void recordRestore(const RecordState& s);
+
+// Logs (counts are totals; entry n is at n % size)
+static RecordEvent recordInputLog[RECORD_INPUTS];
+static RecordEvent recordOutputLog[RECORD_OUTPUTS];
+static RecordCheckpoint recordCheckpoints[RECORD_CHECKPOINTS];
+static RecordSlow recordSlow[RECORD_SLOW_KEPT];
+static uint32_t recordInputCount = 0;
+static uint32_t recordOutputCount = 0;
+static uint32_t recordCheckpointCount = 0;
+static uint32_t recordSeedValue = 0;
+static unsigned long recordStartMs = 0;
+static unsigned long recordLoopStartUs = 0;
+
+// Counters
+static unsigned long recordLoops = 0;
+static unsigned long recordSlowLoops = 0;
+static unsigned long recordLoopMaxUs = 0;
+static unsigned long long recordLoopTotalUs = 0;
+static unsigned long recordOverheadUs = 0;   // time spent writing the logs
+static unsigned long recordModeMs[RECORD_MAX_MODES];
+static uint16_t recordModeEntries[RECORD_MAX_MODES];
+static uint8_t recordMode = 0;
+static unsigned long recordModeSince = 0;
+
+// ms since the end of setup() (negative for times before it)
+int32_t recordTime(unsigned long ms) {
+  return (int32_t)(ms - recordStartMs);
+}
+
+// the millis() value of a recorded time
+unsigned long recordClock(int32_t t) {
+  return recordStartMs + t;
+}
+
+void recordLog(RecordEvent* log, uint16_t size, uint32_t& count, uint8_t type, uint8_t arg, uint16_t value) {
+  unsigned long start = micros();
+  RecordEvent& e = log[count % size];
+  e.timeMs = millis() - recordStartMs;
+  e.type = type;
+  e.arg = arg;
+  e.value = value;
+  count++;
+  recordOverheadUs += micros() - start;
+}
+
+void recordCheckpoint() {
+  unsigned long start = micros();
+  RecordCheckpoint& c = recordCheckpoints[recordCheckpointCount % RECORD_CHECKPOINTS];
+  c.timeMs = millis() - recordStartMs;
+  c.inputs = recordInputCount;
+  c.outputs = recordOutputCount;
+  recordSnapshot(c.state);
+  recordCheckpointCount++;
+  recordOverheadUs += micros() - start;
+}
+
+// provides the seed to give crowRandomSeed() (kept for the dump)
+uint32_t recordSeed(uint32_t seed) {
+  recordSeedValue = seed;
+  return seed;
+}
+
+// marks the end of setup(): recorded times are relative to this
+void recordBegin() {
+  recordStartMs = millis();
+  recordModeSince = recordStartMs;
+  recordLoopStartUs = micros();
+  if (RECORD_SESSION) recordCheckpoint();
+}
+
+// crow-replay: carries on from checkpoint c (the clock already at its time)
+void recordResume(const RecordCheckpoint& c) {
+  recordInputCount = c.inputs;
+  recordOutputCount = c.outputs;
+  recordMode = c.state.mode;
+  recordModeSince = millis();
+  recordRestore(c.state);
+}
+
+// call while the crow is at rest: takes a checkpoint when one is due
+void recordRest(unsigned long now) {
+  if (!RECORD_SESSION || recordCheckpointCount == 0) return;
+  const RecordCheckpoint& last = recordCheckpoints[(recordCheckpointCount - 1) % RECORD_CHECKPOINTS];
+  bool late = (uint32_t)(now - recordStartMs) - last.timeMs >= RECORD_CHECKPOINT_MS;
+  bool inputs = recordInputCount - last.inputs >= RECORD_INPUTS / 2;
+  bool outputs = recordOutputCount - last.outputs >= RECORD_OUTPUTS / 2;
+  if (late || inputs || outputs) recordCheckpoint();
+}
+
+// Loop timing: call recordLoopEnd() before sleeping and recordLoopStart() after
+void recordLoopEnd() {
+  if (!RECORD_SESSION) return;
+  unsigned long elapsed = micros() - recordLoopStartUs;
+  recordLoops++;
+  recordLoopTotalUs += elapsed;
+  if (elapsed > recordLoopMaxUs) recordLoopMaxUs = elapsed;
+  if (elapsed >= RECORD_SLOW_LOOP_US) {
+    RecordSlow& s = recordSlow[recordSlowLoops % RECORD_SLOW_KEPT];
+    s.timeMs = millis() - recordStartMs;
+    s.us = elapsed;
+    recordSlowLoops++;
+  }
+}
+
+void recordLoopStart() {
+  recordLoopStartUs = micros();
+}
+
+void recordSensor(bool high) {
+  if (RECORD_SESSION) recordLog(recordInputLog, RECORD_INPUTS, recordInputCount, REC_SENSOR, high, 0);
+}
+
+void recordButton() {
+  if (RECORD_SESSION) recordLog(recordInputLog, RECORD_INPUTS, recordInputCount, REC_BUTTON, 1, 0);
+}
+
+void recordModeChange(uint8_t from, uint8_t to) {
+  unsigned long now = millis();
+  if (from < RECORD_MAX_MODES) recordModeMs[from] += now - recordModeSince;
+  if (to < RECORD_MAX_MODES) recordModeEntries[to]++;
+  recordMode = to;
+  recordModeSince = now;
+  if (RECORD_SESSION) recordLog(recordOutputLog, RECORD_OUTPUTS, recordOutputCount, REC_MODE, to, from);
+}
+
+void recordTrack(uint8_t track) {
+  if (RECORD_SESSION) recordLog(recordOutputLog, RECORD_OUTPUTS, recordOutputCount, REC_TRACK, track, 0);
+}
+
+// ============================================================================
+// DUMP
+// ============================================================================
+// One record per line, space separated, starting with its kind:
+//   session <version> <SENSOR_MODE> <CORE_SPLIT> <seed>
+//   checkpoint <time> <inputs> <outputs> <random> <nextMove> <nextSquawk>
+//              <nextBlink> <lastAudio> <movementStart> <movementEnd> <neck>
+//              <mode> <eyesOpen> <sensor> <button>
+//   input <n> <time> <type> <level>
+//   mode <n> <time> <from> <to>          (inputs and outputs are numbered
+//   track <n> <time> <track>              separately)
+//   slow <time> <us>
+//   loops <count> <meanUs> <maxUs> <slow> <recorderUs>
+//   modetime <mode> <ms> <entries>
+//   end
+
+#define RECORD_DUMP_VERSION   2
+
+void recordDumpEvents(const RecordEvent* log, uint16_t size, uint32_t count) {
+  uint32_t first = count > size ? count - size : 0;
+  for (uint32_t n = first; n < count; n++) {
+    const RecordEvent& e = log[n % size];
+    if (e.type == REC_MODE) Serial.print(F("mode "));
+    else if (e.type == REC_TRACK) Serial.print(F("track "));
+    else Serial.print(F("input "));
+    Serial.print((unsigned long)n);
+    Serial.print(F(" "));
+    Serial.print((unsigned long)e.timeMs);
+    Serial.print(F(" "));
+    if (e.type == REC_MODE) {
+      Serial.print(e.value);
+      Serial.print(F(" "));
+      Serial.println(e.arg);
+    } else if (e.type == REC_TRACK) {
+      Serial.println(e.arg);
+    } else {
+      Serial.print(e.type);
+      Serial.print(F(" "));
+      Serial.println(e.arg);
+    }
+  }
+}
+
+void recordDump() {
+  Serial.println(F("# ---- crow session (save as a .txt for crow-host/crow-replay) ----"));
+  Serial.print(F("session "));
+  Serial.print(RECORD_DUMP_VERSION);
+  Serial.print(F(" "));
+  Serial.print(SENSOR_MODE);
+  Serial.print(F(" "));
+  Serial.print(CORE_SPLIT ? 1 : 0);
+  Serial.print(F(" "));
+  Serial.println((unsigned long)recordSeedValue);
+
+  uint32_t first = recordCheckpointCount > RECORD_CHECKPOINTS ? recordCheckpointCount - RECORD_CHECKPOINTS : 0;
+  for (uint32_t n = first; n < recordCheckpointCount; n++) {
+    const RecordCheckpoint& c = recordCheckpoints[n % RECORD_CHECKPOINTS];
+    const int32_t values[] = {
+      c.state.nextMoveMs, c.state.nextSquawkMs, c.state.nextBlinkMs, c.state.lastAudioMs,
+      c.state.movementStartMs, c.state.movementEndMs, c.state.neckPosition,
+      c.state.mode, c.state.eyesOpen, c.state.sensor, c.state.button
+    };
+    Serial.print(F("checkpoint "));
+    Serial.print((unsigned long)c.timeMs);
+    Serial.print(F(" "));
+    Serial.print((unsigned long)c.inputs);
+    Serial.print(F(" "));
+    Serial.print((unsigned long)c.outputs);
+    Serial.print(F(" "));
+    Serial.print((unsigned long)c.state.random);
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+      Serial.print(F(" "));
+      Serial.print((long)values[i]);
+    }
+    Serial.println();
+  }
+  recordDumpEvents(recordInputLog, RECORD_INPUTS, recordInputCount);
+  recordDumpEvents(recordOutputLog, RECORD_OUTPUTS, recordOutputCount);
+
+  uint32_t kept = min(recordSlowLoops, (unsigned long)RECORD_SLOW_KEPT);
+  for (uint32_t n = recordSlowLoops - kept; n < recordSlowLoops; n++) {
+    Serial.print(F("slow "));
+    Serial.print((unsigned long)recordSlow[n % RECORD_SLOW_KEPT].timeMs);
+    Serial.print(F(" "));
+    Serial.println((unsigned long)recordSlow[n % RECORD_SLOW_KEPT].us);
+  }
+  Serial.print(F("loops "));
+  Serial.print(recordLoops);
+  Serial.print(F(" "));
+  Serial.print(recordLoops ? (unsigned long)(recordLoopTotalUs / recordLoops) : 0);
+  Serial.print(F(" "));
+  Serial.print(recordLoopMaxUs);
+  Serial.print(F(" "));
+  Serial.print(recordSlowLoops);
+  Serial.print(F(" "));
+  Serial.println(recordOverheadUs);
+
+  unsigned long now = millis();
+  for (uint8_t m = 0; m < RECORD_MAX_MODES; m++) {
+    unsigned long ms = recordModeMs[m] + (m == recordMode ? now - recordModeSince : 0);
+    if (ms == 0 && recordModeEntries[m] == 0) continue;
+    Serial.print(F("modetime "));
+    Serial.print(m);
+    Serial.print(F(" "));
+    Serial.print(ms);
+    Serial.print(F(" "));
+    Serial.println(recordModeEntries[m]);
+  }
+  Serial.println(F("end"));
+}
+
+#endif
@@ -0,0 +1,77 @@
+// ============================================================================
+// BEHAVIOR SCRIPTS
+// ============================================================================
+// Scripts run by behavior.h, one instruction per line. S_JUMP, S_CHANCE and
+// S_IF_SENSOR name an S_LABEL in the same script, e.g.
+//
+//   S_LABEL(1),
+//   S_PLAY(8, 14),
+//   S_WAIT_IDLE,
+//   S_CHANCE(30, 1),   // squawk again 30% of the time
+//   S_END
+//
+// Every script must end with S_END and is checked when the sketch is built
+// (SCRIPT_CHECK at the end of this file). Tracks 1-7 are scolds and 8-14 are
+// squawks (see animations.h).
+//
+// RP2040 only: the ESP32 sketch still runs these behaviors from its mode
+// switch and executeButtonSequence().
+#ifndef SCRIPTS_H
+#define SCRIPTS_H
+
+#include "behavior.h"
+#include "settings.h"
+
+// Motion detected: turn toward the visitor and scold
+constexpr uint8_t scriptScold[] PROGMEM = {
+  S_NECK_SPEED(NECK_FAST),
+  S_NECK_TOWARD(NECK_RANGE_SCOLD_PERCENT),
+  S_PLAY(1, 7),
+  S_WAIT_IDLE,
+  S_END
+};
+
+// Random idle squawk
+constexpr uint8_t scriptSquawk[] PROGMEM = {
+  S_PLAY(8, 14),
+  S_WAIT_IDLE,
+  S_END
+};
+
+// Random idle neck movement
+constexpr uint8_t scriptIdleMove[] PROGMEM = {
+  S_NECK_SPEED(NECK_EITHER),
+  S_NECK_RANDOM(IDLE_NECK_MIN_PERCENT, IDLE_NECK_MAX_PERCENT),
+  S_WAIT_IDLE,
+  S_END
+};
+
+// BUTTON mode "Try Me": scold, look around, squawk, then settle
+constexpr uint8_t scriptTryMe[] PROGMEM = {
+  S_EYES(1),
+  S_WAIT(800),
+  S_NECK_SPEED(NECK_FAST),
+  S_NECK_TOWARD(NECK_RANGE_SCOLD_PERCENT),
+  S_PLAY(1, 7),
+  S_WAIT_IDLE,
+  S_WAIT_RANDOM(1000, 3000),
+  S_NECK_SPEED(NECK_EITHER),
+  S_NECK_RANDOM(IDLE_NECK_MIN_PERCENT, IDLE_NECK_MAX_PERCENT),
+  S_WAIT_IDLE,
+  S_WAIT_RANDOM(1200, 2400),
+  S_PLAY(8, 14),
+  S_WAIT_IDLE,
+  S_WAIT_RANDOM(1000, 3000),
+  S_NECK_SPEED(NECK_SLOW),
+  S_NECK(0),
+  S_WAIT_IDLE,
+  S_EYES(0),
+  S_END
+};
+
+SCRIPT_CHECK(scriptScold);
+SCRIPT_CHECK(scriptSquawk);
+SCRIPT_CHECK(scriptIdleMove);
+SCRIPT_CHECK(scriptTryMe);
+
+#endif
@@ -36,6 +36,8 @@
 #define SERVO_PWM_OPEN                1050  // fully open PWM
 #define SERVO_PWM_CLOSED              1250  // fully closed PWM
 #define SERVO_EASING_FACTOR           3.00  // determines animation smooting (smaller is smoother)
+#define SERVO_LAG_BASE_MS             0     // beak lag behind any move, ms (measure with calibrate-crow)
+#define SERVO_LAG_TRAVEL_MS           0     // added lag for a full open-close move, ms
 
 // Audio Settings
 #define DFPLAYER_VOLUME               25    // Volume 0-30
@@ -68,4 +70,66 @@
 #define NECK_SPEED_FAST_ACCEL         4000  // Fast movement acceleration
 #define NECK_RANGE_SCOLD_PERCENT        20  // Percent of range to move during scold (+/-)
 
+// Power Settings
+#define POWER_RELEASE_COILS           true  // De-energize the neck stepper once it has settled
+#define POWER_COIL_RELEASE_MS         500   // How long the neck must be still before releasing
+#define POWER_IDLE_SLEEP              true  // Sleep between scheduled events (motion sensor wakes the crow)
+#define POWER_MIN_SLEEP_MS            2     // Skip sleeps shorter than this
+#define POWER_MAX_SLEEP_MS            1000  // Longest single sleep
+#define POWER_REPORT_MS               60000 // Log power counters to Serial (0 to disable)
+
+// Core Split - Core1 runs sensors, behaviors, beak animation and audio; Core0 only drives the neck and beak
+#define CORE_SPLIT                    true  // false: Core0 runs everything and Core1 only polls the sensor
+#define MOTION_REPORT_MS              60000 // Log Core0's stepper loop rate and jitter (0 to disable)
+
+// Health Monitor (send 'h' on the Serial Monitor for the fault counters)
+#define HEALTH_WATCHDOG               true  // Reboot through the hardware watchdog if either core stops
+#define HEALTH_WDT_MS                 4000  // Watchdog timeout (max 8300, must be > POWER_MAX_SLEEP_MS)
+#define HEALTH_QUICK_RESTART          true  // Skip the startup show (waits, beak sweep, sound, sensor test) after a watchdog reboot
+#define HEALTH_CORE_TIMEOUT_MS        3000  // Reboot if Core1 misses its heartbeat this long
+#define HEALTH_MODE_TIMEOUT_MS        30000 // Reset the crow if a mode (or the button sequence) lasts longer
+#define HEALTH_ANIM_GRACE_MS          1000  // Stop a beak animation running this far past its end
+#define HEALTH_DFPLAYER_CHECK_MS      300000 // Check the DFPlayer still answers this often while idle (0 to disable)
+#define HEALTH_DFPLAYER_RETRY_MS      30000 // Restart a failed DFPlayer this often while idle
+#define HEALTH_DFPLAYER_REPLY_MS      2000  // Give up on a DFPlayer check or restart after this long without a reply
+
+// Memory Budget (checked when building; see memory.h and crow-host/memory-budget.py)
+#define MEMORY_FLASH_BUDGET_KB        512   // Program flash the firmware may use
+#define MEMORY_RAM_BUDGET_KB          64    // Static RAM (data + bss) the firmware may use
+#define MEMORY_ANIM_BUDGET_BYTES      4096  // Flash for the beak animation tables
+
+// Session Recorder (send 'r' on the Serial Monitor, replay the dump with crow-host/crow-replay)
+#define RECORD_SESSION                true  // Record sensor/button input, mode changes/tracks, checkpoints and slow loops
+#define RECORD_INPUTS                 256   // Sensor/button edges kept (8 bytes each, oldest dropped first)
+#define RECORD_OUTPUTS                128   // Mode changes and tracks played kept (8 bytes each, oldest dropped first)
+#define RECORD_CHECKPOINTS            8     // Replay starting points kept (48 bytes each)
+#define RECORD_CHECKPOINT_MS          60000 // Checkpoint the crow at rest at least this often
+#define RECORD_SLOW_LOOP_US           2000  // Count loops slower than this (the last 16 are kept)
+
+// Directional Tracking - a second sensor on SNSR2 watches the other side of the path
+#define SENSOR_TRACKING               false // true: aim the head at the visitor using both sensors (PIR/LD1020)
+#define PIN_MOTION_SENSOR2            26    // SNSR2
+#define TRACK_SENSOR1_SIDE            1     // Neck direction SENSOR1 watches (1 or -1); SENSOR2 watches the other
+#define TRACK_WINDOW_MS               2000  // Edges on both sensors within this are one visitor crossing
+#define TRACK_FAST_MS                 300   // A crossing this quick is full speed
+#define TRACK_SLOW_MS                 1500  // A crossing this slow (or slower) is standing still
+#define TRACK_AIM_PERCENT             40    // Percent of range to turn toward the visitor
+#define TRACK_LEAD_PERCENT            40    // Extra percent ahead of a full speed visitor
+
+// FLOCK MODE - Choose one mode: FLOCK_MODE_OFF, FLOCK_MODE_LEADER, FLOCK_MODE_FOLLOWER
+// Crows share sensor events over an RS-485 bus; the leader schedules scolds and head-turn waves
+#define FLOCK_MODE                    FLOCK_MODE_OFF
+#define FLOCK_NODE_ID                 0     // Position along the path (leader must be 0)
+#define FLOCK_NODE_COUNT              4     // Number of crows on the bus (including the leader)
+#define PIN_FLOCK_TX                  2     // Expansion header (CC5x12 v1.2)
+#define PIN_FLOCK_RX                  3
+#define PIN_FLOCK_DE                  4     // RS-485 DE/RE (-1 if not used)
+#define FLOCK_BAUD                    57600 // Bus speed (6 byte frames)
+#define FLOCK_CYCLE_MS                100   // Bus cycle: bounds sensor-to-leader latency
+#define FLOCK_SLOT_MS                 5     // Transmit slot per node (FLOCK_NODE_COUNT slots must fit a cycle)
+#define FLOCK_LEADER_TIMEOUT_MS       1000  // Followers act standalone when the leader goes quiet
+#define FLOCK_WAVE_STEP_MS            250   // Delay between neighbors turning toward the scolding crow
+#define FLOCK_TURN_PERCENT            60    // Percent of range to turn toward the scolding crow
+#define FLOCK_TURN_DIRECTION          1     // Set to -1 if crows turn away from lower node ids
+
 #endif
@@ -0,0 +1,141 @@
+// ============================================================================
+// DIRECTIONAL TRACKING
+// ============================================================================
+// SENSOR1 and SENSOR2 watch opposite sides of the path. Rising edges on both
+// pins are timestamped by interrupts on the core that runs the crow (Core1
+// with CORE_SPLIT, see initializeSleep()), and they wake it from its idle
+// sleep, so trackUpdate() sees them on its next pass rather than at the next
+// sensor poll.
+//
+// An edge on one sensor alone means a visitor has arrived on that side. An
+// edge on one sensor within TRACK_WINDOW_MS of an edge on the other means a
+// visitor crossed toward the second sensor; the time between the two edges
+// gives the speed, and faster visitors are led further along.
+//
+// trackEstimate() is arithmetic only, so it can be checked against made-up
+// edge timings without sensors attached.
+#ifndef TRACKING_H
+#define TRACKING_H
+
+#include <Arduino.h>
+#include <hardware/sync.h>
+#include "settings.h"
+#include "power.h"
+
+#if SENSOR_TRACKING
+#if SENSOR_MODE == SENSOR_MODE_BUTTON || SENSOR_MODE == SENSOR_MODE_NONE
+#error "SENSOR_TRACKING requires SENSOR_MODE_PIR or SENSOR_MODE_LD1020"
+#endif
+#endif
+
+struct TrackEstimate {
+  int8_t side;          // neck direction of the visitor (1 or -1)
+  uint8_t speedPercent; // 0 (standing or slow) to 100 (crossing in TRACK_FAST_MS)
+  uint8_t aimPercent;   // percent of the neck range to turn toward side
+  bool crossing;        // seen by one sensor and then the other
+};
+
+// Edge Capture (written by interrupts)
+static volatile unsigned long trackEdgeUs[2];
+static volatile uint16_t trackEdgeCount[2];
+
+// Tracker State
+static uint16_t trackSeen[2];
+static unsigned long trackLastUs[2];   // last rising edge per sensor
+static bool trackHaveEdge[2];
+static bool trackPaired[2];            // last edge already used in a crossing
+static TrackEstimate trackLast;
+static unsigned long trackLastMs = 0;  // when trackLast was made
+static bool trackValid = false;
+static unsigned long trackDecisionUs = 0;  // edge to estimate
+
+// Counters
+static unsigned long trackArrivals = 0;
+static unsigned long trackCrossings = 0;
+
+void trackEdge(uint8_t sensor, uint8_t pin) {
+  if (digitalRead(pin)) {
+    trackEdgeUs[sensor] = micros();
+    trackEdgeCount[sensor]++;
+  }
+  if (POWER_IDLE_SLEEP) powerSensorEdge(); // replaces the power manager's wake
+}
+
+void trackEdge1() { trackEdge(0, PIN_MOTION_SENSOR); }
+void trackEdge2() { trackEdge(1, PIN_MOTION_SENSOR2); }
+
+void trackBegin() {
+  pinMode(PIN_MOTION_SENSOR2, INPUT);
+  attachInterrupt(digitalPinToInterrupt(PIN_MOTION_SENSOR), trackEdge1, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(PIN_MOTION_SENSOR2), trackEdge2, CHANGE);
+}
+
+// provides the estimate for a visitor last seen by sensor (0 or 1), after
+// crossing from the other sensor in dtMs (0: seen by this sensor alone)
+TrackEstimate trackEstimate(uint8_t sensor, unsigned long dtMs) {
+  TrackEstimate e;
+  e.side = (sensor == 0) ? TRACK_SENSOR1_SIDE : -TRACK_SENSOR1_SIDE;
+  e.crossing = dtMs > 0;
+  e.speedPercent = 0;
+  if (e.crossing) {
+    if (dtMs <= TRACK_FAST_MS) e.speedPercent = 100;
+    else if (dtMs < TRACK_SLOW_MS) e.speedPercent = (TRACK_SLOW_MS - dtMs) * 100 / (TRACK_SLOW_MS - TRACK_FAST_MS);
+  }
+  int aim = TRACK_AIM_PERCENT + TRACK_LEAD_PERCENT * e.speedPercent / 100;
+  e.aimPercent = aim > 100 ? 100 : aim;
+  return e;
+}
+
+// pairs new rising edges; true when a new estimate is ready in trackLast
+bool trackUpdate(unsigned long now) {
+  // the interrupts run on this core (see initializeSleep()), so masking them
+  // keeps each count and its edge time together
+  uint16_t count[2];
+  unsigned long edgeUs[2];
+  uint32_t status = save_and_disable_interrupts();
+  for (uint8_t s = 0; s < 2; s++) {
+    count[s] = trackEdgeCount[s];
+    edgeUs[s] = trackEdgeUs[s];
+  }
+  restore_interrupts(status);
+
+  // handle the earlier edge first when both sensors fired since the last loop
+  uint8_t first = 0;
+  if (count[0] != trackSeen[0] && count[1] != trackSeen[1] && (long)(edgeUs[1] - edgeUs[0]) < 0) first = 1;
+
+  bool updated = false;
+  for (uint8_t i = 0; i < 2; i++) {
+    uint8_t s = first ^ i;
+    uint8_t other = s ^ 1;
+    if (count[s] == trackSeen[s]) continue;
+    trackSeen[s] = count[s];
+
+    unsigned long dtMs = 0;
+    unsigned long dtUs = edgeUs[s] - trackLastUs[other];
+    if (trackHaveEdge[other] && !trackPaired[other] && dtUs <= TRACK_WINDOW_MS * 1000UL) {
+      dtMs = max(dtUs / 1000, 1UL);
+      trackPaired[other] = true;
+      trackPaired[s] = true;
+      trackCrossings++;
+    } else {
+      trackPaired[s] = false;
+      trackArrivals++;
+    }
+    trackLastUs[s] = edgeUs[s];
+    trackHaveEdge[s] = true;
+
+    trackLast = trackEstimate(s, dtMs);
+    trackLastMs = now;
+    trackValid = true;
+    trackDecisionUs = micros() - edgeUs[s];
+    updated = true;
+  }
+  return updated;
+}
+
+// true while the last estimate is recent enough to aim at
+bool trackFresh(unsigned long now) {
+  return trackValid && now - trackLastMs < TRACK_WINDOW_MS;
+}
+
+#endif
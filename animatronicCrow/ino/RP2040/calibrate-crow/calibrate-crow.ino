@@ -15,7 +15,9 @@
 #include <AccelStepper.h>
 #include "settings.h"
 #include "animations.h"
+#include "calibration.h"
 #include "crow-utils.h"
+#include "servo-lag.h"
 
 // Reuse production objects
 AccelStepper stepper(AccelStepper::HALF4WIRE, PIN_STEPPER_1, PIN_STEPPER_3, PIN_STEPPER_2, PIN_STEPPER_4);
@@ -33,6 +35,12 @@ unsigned int beakClosed = 0;
 unsigned int dfVolume = 0;
 unsigned int audDelay = AUDIO_SYNC_DELAY_MS;
 float eFactor = SERVO_EASING_FACTOR;
+unsigned int neckAccel = 0;
+unsigned int neckMax = 0;
+unsigned int neckSlowAccel = 0;
+unsigned int neckSlowMax = 0;
+unsigned int lagBase = SERVO_LAG_BASE_MS;
+unsigned int lagTravel = SERVO_LAG_TRAVEL_MS;
 
 unsigned long moveStartTime = 0;
 enum TestState {
@@ -68,6 +76,28 @@ void setup() {
   delay(2000);
   dfPlayer.volume(15);
   delay(200);
+
+  // Resume from the stored calibration, if any
+  CalibrationStatus calStatus = loadCalibration();
+  if (calStatus == CAL_LOADED || calStatus == CAL_REBUILT) {
+    beakOpen = crowCal.pwmOpen;
+    beakClosed = crowCal.pwmClosed;
+    eFactor = crowCal.easingFactor;
+    easingLUTSet = true;
+    if (crowCal.fields & CAL_HAS_VOLUME) {
+      dfVolume = crowCal.volume;
+      dfPlayer.volume(dfVolume);
+    }
+    if (crowCal.fields & CAL_HAS_SYNC_DELAY) audDelay = crowCal.audioSyncDelayMs;
+    lagBase = crowCal.lagBaseMs;
+    lagTravel = crowCal.lagTravelMs;
+    Serial.println(F("Stored calibration loaded:"));
+    printCalibration();
+  } else if (calStatus == CAL_CORRUPT) {
+    Serial.println(F("Stored calibration is corrupt, ignoring"));
+  } else if (calStatus == CAL_UNSUPPORTED) {
+    Serial.println(F("Stored calibration is from a newer version, ignoring"));
+  }
 }
 
 void loop() {
@@ -159,6 +189,8 @@ void loop() {
           int testMax = (max > 0) ? max : 7000;
           stepper.setMaxSpeed(testMax);
           stepper.setAcceleration(val);
+          neckAccel = val;
+          neckMax = testMax;
           stepperMoveIdx = 0;
           currentNeckState = SWEEP;
           Serial.print(F("Neck: testing accel ")); Serial.print(val);
@@ -166,6 +198,21 @@ void loop() {
         }
         break;
       }
+      case 'i': { // idle (slow) neck speed, swept like 'n'
+        int val = Serial.parseInt();
+        int max = Serial.parseInt();
+        if (val <= 0) break;
+        int testMax = (max > 0) ? max : NECK_SPEED_SLOW_MAX;
+        stepper.setMaxSpeed(testMax);
+        stepper.setAcceleration(val);
+        neckSlowAccel = val;
+        neckSlowMax = testMax;
+        stepperMoveIdx = 0;
+        currentNeckState = SWEEP;
+        Serial.print(F("Neck: testing idle accel ")); Serial.print(val);
+        Serial.print(F(" max ")); Serial.println(testMax);
+        break;
+      }
       case 'e': {
         int val = Serial.parseInt();
         if (val == 0) {
@@ -179,12 +226,79 @@ void loop() {
         }
         break;
       }
+      case 'l': {
+        if (!easingLUTSet) {
+          Serial.println(F("Lag measurement is blocked until Beak Servo limits are set"));
+          break;
+        }
+        int base = Serial.parseInt();
+        int travel = Serial.parseInt();
+        if (base < 0) { // lead off
+          lagBase = 0;
+          lagTravel = 0;
+        } else if (base > 0 || travel > 0) {
+          lagBase = base;
+          lagTravel = travel;
+        } else if (PIN_SERVO_FEEDBACK < 0) {
+          Serial.println(F("Lag: set PIN_SERVO_FEEDBACK to measure, or enter 'l <base> <travel>'"));
+          break;
+        } else {
+          Serial.println(F("Lag: measuring, the beak will step through its range..."));
+          uint16_t fitBase, fitTravel;
+          bool fitted = measureServoLag(fitBase, fitTravel);
+          currentPulse = targetPulse = easingLUT[0];
+          if (!fitted) {
+            Serial.println(F("Lag: measurement failed (check the feedback pot wiring)"));
+            break;
+          }
+          lagBase = fitBase;
+          lagTravel = fitTravel;
+        }
+        setServoLag(lagBase, lagTravel);
+        Serial.print(F("Lag: beak leads by ")); Serial.print(lagBase);
+        Serial.print(F("ms + ")); Serial.print(lagTravel); Serial.println(F("ms per full move"));
+        break;
+      }
       case 'p': {
-        if (beakOpen > 0)                    { Serial.print(F("#define SERVO_PWM_OPEN      ")); Serial.println(beakOpen); }
-        if (beakClosed > 0)                  { Serial.print(F("#define SERVO_PWM_CLOSED    ")); Serial.println(beakClosed); }
-        if (dfVolume > 0)                    { Serial.print(F("#define DFPLAYER_VOLUME     ")); Serial.println(dfVolume); }
-        if (audDelay != AUDIO_SYNC_DELAY_MS) { Serial.print(F("#define AUDIO_SYNC_DELAY_MS ")); Serial.println(audDelay); }
-        if (eFactor != SERVO_EASING_FACTOR)  { Serial.print(F("#define SERVO_EASING_FACTOR ")); Serial.println(eFactor); }
+        printCalibration();
+        break;
+      }
+      case 'w': {
+        if (!easingLUTSet) {
+          Serial.println(F("Saving is blocked until Beak Servo limits are set"));
+          break;
+        }
+        crowCal.pwmOpen = beakOpen;
+        crowCal.pwmClosed = beakClosed;
+        crowCal.easingFactor = eFactor;
+        if (dfVolume > 0) {
+          crowCal.volume = dfVolume;
+          crowCal.fields |= CAL_HAS_VOLUME;
+        }
+        if (audDelay != AUDIO_SYNC_DELAY_MS) {
+          crowCal.audioSyncDelayMs = audDelay;
+          crowCal.fields |= CAL_HAS_SYNC_DELAY;
+        }
+        if (neckAccel > 0) {
+          crowCal.neckFastAccel = neckAccel;
+          crowCal.neckFastMax = neckMax;
+          crowCal.fields |= CAL_HAS_NECK_FAST;
+        }
+        if (neckSlowAccel > 0) {
+          crowCal.neckSlowAccel = neckSlowAccel;
+          crowCal.neckSlowMax = neckSlowMax;
+          crowCal.fields |= CAL_HAS_NECK_SLOW;
+        }
+        crowCal.lagBaseMs = lagBase;
+        crowCal.lagTravelMs = lagTravel;
+        crowCal.fields |= CAL_HAS_SERVO_LAG;
+        if (saveCalibration()) Serial.println(F("Calibration saved to flash"));
+        else Serial.println(F("Calibration save failed!"));
+        break;
+      }
+      case 'x': {
+        if (clearCalibration()) Serial.println(F("Stored calibration cleared (settings.h will be used)"));
+        else Serial.println(F("Calibration clear failed!"));
         break;
       }
       case '?': {
@@ -265,6 +379,21 @@ void updateNeck() {
   }
 }
 
+void printCalibration() {
+  if (beakOpen > 0)                    { Serial.print(F("#define SERVO_PWM_OPEN        ")); Serial.println(beakOpen); }
+  if (beakClosed > 0)                  { Serial.print(F("#define SERVO_PWM_CLOSED      ")); Serial.println(beakClosed); }
+  if (dfVolume > 0)                    { Serial.print(F("#define DFPLAYER_VOLUME       ")); Serial.println(dfVolume); }
+  if (audDelay != AUDIO_SYNC_DELAY_MS) { Serial.print(F("#define AUDIO_SYNC_DELAY_MS   ")); Serial.println(audDelay); }
+  if (eFactor != SERVO_EASING_FACTOR)  { Serial.print(F("#define SERVO_EASING_FACTOR   ")); Serial.println(eFactor); }
+  if (neckAccel > 0)                   { Serial.print(F("#define NECK_SPEED_FAST_MAX   ")); Serial.println(neckMax);
+                                         Serial.print(F("#define NECK_SPEED_FAST_ACCEL ")); Serial.println(neckAccel); }
+  if (neckSlowAccel > 0)               { Serial.print(F("#define NECK_SPEED_SLOW_MAX   ")); Serial.println(neckSlowMax);
+                                         Serial.print(F("#define NECK_SPEED_SLOW_ACCEL ")); Serial.println(neckSlowAccel); }
+  if (lagBase != SERVO_LAG_BASE_MS || lagTravel != SERVO_LAG_TRAVEL_MS) {
+                                         Serial.print(F("#define SERVO_LAG_BASE_MS     ")); Serial.println(lagBase);
+                                         Serial.print(F("#define SERVO_LAG_TRAVEL_MS   ")); Serial.println(lagTravel); }
+}
+
 void printInstructions() {
   Serial.println(F("--- Crow Diagnostic & Calibration Utility ------------------------------------"));
   Serial.println(F("Commands:"));
@@ -275,8 +404,13 @@ void printInstructions() {
   Serial.println(F("  n -1              : Neck Stepper: Center"));
   Serial.println(F("  n 0               : Neck Stepper: Stop"));
   Serial.println(F("  n <accel> <max>   : Neck Stepper: Test accel (+optional max speed) sweep"));
+  Serial.println(F("  i <accel> <max>   : Neck Stepper: Test idle (slow) accel (+optional max speed) sweep"));
   Serial.println(F("  f <float>         : Animation smoothing factor (1.0: smoother 4.0: snappier)"));
   Serial.println(F("  e <0-1>           : Eyes mirror button/sensor: 0 for NO, 1 for YES"));
-  Serial.println(F("  p                 : Print modified PWM, Vol, Delay, and Factor to monitor"));
+  Serial.println(F("  l                 : Measure beak lag (needs PIN_SERVO_FEEDBACK), prints curves"));
+  Serial.println(F("  l <base> <travel> : Set beak lead ms (+ms for a full move), 'l -1' for none"));
+  Serial.println(F("  p                 : Print modified PWM, Vol, Delay, Factor, Neck and Lag to monitor"));
+  Serial.println(F("  w                 : Write calibration to flash (animatronic-crow loads it at boot)"));
+  Serial.println(F("  x                 : Clear stored calibration (animatronic-crow uses settings.h)"));
   Serial.println(F("------------------------------------------------------------------------------"));
 }
\ No newline at end of file
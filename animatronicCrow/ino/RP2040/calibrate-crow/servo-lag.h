@@ -0,0 +1,137 @@
+// ============================================================================
+// SERVO LAG CHARACTERIZATION
+// ============================================================================
+// Steps the beak from closed through increasing travel and times how long a
+// feedback servo's pot (PIN_SERVO_FEEDBACK) takes to cover LAG_ARRIVAL_PCT of
+// each move. Each move prints its settled readings as
+// "lagspan,<travel>,<adcFrom>,<adcTo>" and every sample as
+// "lag,<travel>,<ms>,<adc>" so the response curves can be saved, then a line
+// is fitted to the arrival times:
+//
+//   lag = base + travelMs * travel% / 100
+//
+// lagFromCurve() and fitServoLag() are arithmetic only: crow-host's
+// fit-servo-lag reruns them on saved curves.
+#ifndef SERVO_LAG_H
+#define SERVO_LAG_H
+
+#include <Arduino.h>
+#include "settings.h"
+#include "animations.h"
+
+#define LAG_TRAVEL_STEPS      5      // moves of 20, 40 ... 100%
+#define LAG_REPEATS           3      // timed moves per travel
+#define LAG_SETTLE_MS         400    // wait for the beak to stop before reading
+#define LAG_TIMEOUT_MS        300    // recording window per move
+#define LAG_ARRIVAL_PCT       90     // arrived once this much of the move is covered
+#define LAG_ADC_SAMPLES       8      // averaged for the settled readings
+#define LAG_MIN_SPAN          8      // smallest ADC change that counts as movement
+
+extern Servo beakServo;
+
+static uint16_t lagCurve[LAG_TIMEOUT_MS];
+
+// least-squares fit of lag = base + travelMs * travel / 100
+bool fitServoLag(const uint8_t* travel, const uint16_t* lagMs, uint8_t n, uint16_t& baseMs, uint16_t& travelMs) {
+  if (n < 2) return false;
+  float sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    float x = travel[i] / 100.0;
+    sx += x;
+    sy += lagMs[i];
+    sxx += x * x;
+    sxy += x * lagMs[i];
+  }
+  float d = n * sxx - sx * sx;
+  if (d == 0) return false; // all moves had the same travel
+  float slope = (n * sxy - sx * sy) / d;
+  float intercept = (sy - slope * sx) / n;
+  baseMs = intercept > 0 ? (uint16_t)(intercept + 0.5) : 0;
+  travelMs = slope > 0 ? (uint16_t)(slope + 0.5) : 0;
+  return true;
+}
+
+// provides the sample at which a move between the settled readings from and
+// to first covered LAG_ARRIVAL_PCT of it, or -1 if it never did (or is too
+// small to time)
+int lagFromCurve(const uint16_t* samples, uint16_t n, int from, int to) {
+  long span = to - from;
+  if (abs(span) < LAG_MIN_SPAN) return -1;
+  for (uint16_t t = 0; t < n; t++) {
+    if (((long)samples[t] - from) * span * 100 >= span * span * LAG_ARRIVAL_PCT) return t;
+  }
+  return -1;
+}
+
+int readFeedback() {
+  long sum = 0;
+  for (uint8_t i = 0; i < LAG_ADC_SAMPLES; i++) sum += analogRead(PIN_SERVO_FEEDBACK);
+  return sum / LAG_ADC_SAMPLES;
+}
+
+// times one move from -> to and prints its curve; provides the lag or -1
+int timeServoMove(uint8_t travel, int fromPWM, int toPWM) {
+  // settled pot readings at both ends
+  beakServo.writeMicroseconds(toPWM);
+  delay(LAG_SETTLE_MS);
+  int adcTo = readFeedback();
+  beakServo.writeMicroseconds(fromPWM);
+  delay(LAG_SETTLE_MS);
+  int adcFrom = readFeedback();
+  if (abs(adcTo - adcFrom) < LAG_MIN_SPAN) return -1;
+
+  // 1ms samples of the move
+  unsigned long start = millis();
+  beakServo.writeMicroseconds(toPWM);
+  for (uint16_t t = 0; t < LAG_TIMEOUT_MS; t++) {
+    while (millis() - start < t);
+    lagCurve[t] = analogRead(PIN_SERVO_FEEDBACK);
+  }
+
+  Serial.print(F("lagspan,"));
+  Serial.print(travel);
+  Serial.print(F(","));
+  Serial.print(adcFrom);
+  Serial.print(F(","));
+  Serial.println(adcTo);
+  for (uint16_t t = 0; t < LAG_TIMEOUT_MS; t++) {
+    Serial.print(F("lag,"));
+    Serial.print(travel);
+    Serial.print(F(","));
+    Serial.print(t);
+    Serial.print(F(","));
+    Serial.println(lagCurve[t]);
+  }
+  beakServo.writeMicroseconds(fromPWM);
+  return lagFromCurve(lagCurve, LAG_TIMEOUT_MS, adcFrom, adcTo);
+}
+
+// measures moves across the beak range and fits the lag model
+bool measureServoLag(uint16_t& baseMs, uint16_t& travelMs) {
+  if (PIN_SERVO_FEEDBACK < 0) return false;
+  if (!beakServo.attached()) beakServo.attach(PIN_SERVO, SERVO_PWM_MIN, SERVO_PWM_MAX);
+
+  uint8_t travel[LAG_TRAVEL_STEPS * LAG_REPEATS];
+  uint16_t lagMs[LAG_TRAVEL_STEPS * LAG_REPEATS];
+  uint8_t n = 0;
+  Serial.println(F("lag,travel,ms,adc"));
+  for (uint8_t step = 1; step <= LAG_TRAVEL_STEPS; step++) {
+    uint8_t tr = step * 100 / LAG_TRAVEL_STEPS;
+    for (uint8_t r = 0; r < LAG_REPEATS; r++) {
+      int lag = timeServoMove(tr, easingLUT[0], easingLUT[tr]);
+      Serial.print(F("# travel ")); Serial.print(tr);
+      if (lag < 0) {
+        Serial.println(F("%: no arrival"));
+        continue;
+      }
+      Serial.print(F("%: ")); Serial.print(lag); Serial.println(F("ms"));
+      travel[n] = tr;
+      lagMs[n] = lag;
+      n++;
+    }
+  }
+  beakServo.writeMicroseconds(easingLUT[0]);
+  return fitServoLag(travel, lagMs, n, baseMs, travelMs);
+}
+
+#endif
@@ -0,0 +1,162 @@
+// ============================================================================
+// STORED CALIBRATION v2
+// ============================================================================
+// calibrate-crow commits beak limits, easing, volume, sync delay, the neck
+// profile and the servo lag model to flash (EEPROM emulation) along with the precomputed easing table.
+// animatronic-crow loads the record at boot and falls back to settings.h when
+// the record is missing, from a newer version, or fails its CRC.
+//
+// The payload is append-only: new fields go at the end and bump the version.
+// An older (shorter) record still loads; fields it lacks keep their defaults.
+// A field that was always stored but not used gets a CAL_HAS_* flag instead,
+// since records written before the flag existed have it clear.
+//
+// >> One file, five copies: animatronic-crow, calibrate-crow (RP2040 and
+// ESP32) and crow-bench must carry the same bytes, or a crow reads another
+// sketch's record wrong. Edit the RP2040 animatronic-crow copy and copy it
+// over; `make check-copies` in RP2040/crow-host fails when they differ. <<
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "settings.h"
+#include "animations.h"
+
+#define CALIBRATION_MAGIC     0x574F5243UL // "CROW"
+#define CALIBRATION_VERSION   2
+#define CALIBRATION_EEPROM    512          // bytes of flash reserved for the record
+
+// Optional fields (beak limits, easing and the table are always stored)
+#define CAL_HAS_VOLUME        0x01
+#define CAL_HAS_SYNC_DELAY    0x02
+#define CAL_HAS_NECK_FAST     0x04
+#define CAL_HAS_SERVO_LAG     0x08
+#define CAL_HAS_NECK_SLOW     0x10
+
+struct CalibrationHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t length;  // payload bytes
+  uint32_t crc;     // CRC-32 of the payload
+};
+
+struct CalibrationPayload {
+  uint16_t pwmOpen;
+  uint16_t pwmClosed;
+  float    easingFactor;
+  uint8_t  fields;
+  uint8_t  volume;
+  uint16_t audioSyncDelayMs;
+  uint16_t neckSlowMax;
+  uint16_t neckSlowAccel;
+  uint16_t neckFastMax;
+  uint16_t neckFastAccel;
+  uint16_t easingLUT[101];
+  // v2
+  uint16_t lagBaseMs;
+  uint16_t lagTravelMs;
+  // v3+ fields go here
+};
+
+static_assert(sizeof(CalibrationHeader) + sizeof(CalibrationPayload) <= CALIBRATION_EEPROM,
+              "calibration record does not fit CALIBRATION_EEPROM");
+
+// Active calibration (settings.h defaults until a record is loaded)
+static CalibrationPayload crowCal = {
+  SERVO_PWM_OPEN, SERVO_PWM_CLOSED, SERVO_EASING_FACTOR, 0,
+  DFPLAYER_VOLUME, AUDIO_SYNC_DELAY_MS,
+  NECK_SPEED_SLOW_MAX, NECK_SPEED_SLOW_ACCEL, NECK_SPEED_FAST_MAX, NECK_SPEED_FAST_ACCEL,
+  {0},
+  SERVO_LAG_BASE_MS, SERVO_LAG_TRAVEL_MS
+};
+
+enum CalibrationStatus : uint8_t {
+  CAL_LOADED,       // record applied, easing table used as stored
+  CAL_REBUILT,      // record applied, easing table recomputed (old or inconsistent record)
+  CAL_EMPTY,        // nothing stored
+  CAL_UNSUPPORTED,  // written by a newer version
+  CAL_CORRUPT       // CRC or length check failed
+};
+
+uint32_t calibrationCrc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFFUL;
+  while (len--) {
+    crc ^= *data++;
+    for (uint8_t i = 0; i < 8; i++) crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+// reads the record into crowCal and easingLUT; crowCal keeps its defaults on failure
+CalibrationStatus loadCalibration() {
+  EEPROM.begin(CALIBRATION_EEPROM);
+
+  CalibrationHeader header;
+  EEPROM.get(0, header);
+  if (header.magic != CALIBRATION_MAGIC) return CAL_EMPTY;
+  if (header.version > CALIBRATION_VERSION) return CAL_UNSUPPORTED;
+  if (header.length == 0 || header.length > sizeof(CalibrationPayload)) return CAL_CORRUPT;
+
+  // overlay the stored bytes on the defaults so missing trailing fields survive
+  CalibrationPayload payload = crowCal;
+  uint8_t* bytes = (uint8_t*)&payload;
+  for (uint16_t i = 0; i < header.length; i++) {
+    bytes[i] = EEPROM.read(sizeof(CalibrationHeader) + i);
+  }
+  if (calibrationCrc32(bytes, header.length) != header.crc) return CAL_CORRUPT;
+
+  crowCal.pwmOpen = payload.pwmOpen;
+  crowCal.pwmClosed = payload.pwmClosed;
+  crowCal.easingFactor = payload.easingFactor;
+  crowCal.fields = payload.fields;
+  if (payload.fields & CAL_HAS_VOLUME) crowCal.volume = payload.volume;
+  if (payload.fields & CAL_HAS_SYNC_DELAY) crowCal.audioSyncDelayMs = payload.audioSyncDelayMs;
+  if (payload.fields & CAL_HAS_NECK_SLOW) {
+    crowCal.neckSlowMax = payload.neckSlowMax;
+    crowCal.neckSlowAccel = payload.neckSlowAccel;
+  }
+  if (payload.fields & CAL_HAS_NECK_FAST) {
+    crowCal.neckFastMax = payload.neckFastMax;
+    crowCal.neckFastAccel = payload.neckFastAccel;
+  }
+  if (payload.fields & CAL_HAS_SERVO_LAG) {
+    crowCal.lagBaseMs = payload.lagBaseMs;
+    crowCal.lagTravelMs = payload.lagTravelMs;
+  }
+  setServoLag(crowCal.lagBaseMs, crowCal.lagTravelMs);
+
+  // use the stored table only if it is complete and matches the limits
+  bool haveLUT = header.length >= offsetof(CalibrationPayload, easingLUT) + sizeof(payload.easingLUT);
+  if (haveLUT && payload.easingLUT[0] == payload.pwmClosed && payload.easingLUT[100] == payload.pwmOpen) {
+    memcpy(easingLUT, payload.easingLUT, sizeof(easingLUT));
+    return CAL_LOADED;
+  }
+  hydrateEasingLUT(crowCal.pwmOpen, crowCal.pwmClosed, crowCal.easingFactor);
+  return CAL_REBUILT;
+}
+
+// writes crowCal and the current easingLUT to flash
+bool saveCalibration() {
+  memcpy(crowCal.easingLUT, easingLUT, sizeof(easingLUT));
+
+  CalibrationHeader header;
+  header.magic = CALIBRATION_MAGIC;
+  header.version = CALIBRATION_VERSION;
+  header.length = sizeof(CalibrationPayload);
+  header.crc = calibrationCrc32((const uint8_t*)&crowCal, sizeof(CalibrationPayload));
+
+  EEPROM.begin(CALIBRATION_EEPROM);
+  EEPROM.put(0, header);
+  EEPROM.put(sizeof(CalibrationHeader), crowCal);
+  return EEPROM.commit();
+}
+
+// invalidates the stored record so the crow boots from settings.h
+bool clearCalibration() {
+  EEPROM.begin(CALIBRATION_EEPROM);
+  EEPROM.put(0, (uint32_t)0);
+  return EEPROM.commit();
+}
+
+#endif
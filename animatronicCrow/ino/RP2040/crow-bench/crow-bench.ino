@@ -0,0 +1,298 @@
+/*
+ * Crow Benchmarks
+ * ---------------------------
+ * Times the crow's hot paths on the RP2040 and prints one JSON line per run
+ * on the Serial Monitor so results can be saved and compared between commits.
+ * Each benchmark has a limit; the run fails if any limit is crossed.
+ *
+ * - getAnimPos() / getEasedAnimPWM() across all animations
+ * - hydrateEasingLUT()
+ * - handleBlinking()
+ * - updateBeak()
+ * - scriptUpdate() stepping the "Try Me" behavior script
+ * - AccelStepper run() scheduling cost and runSpeed() step-rate accuracy
+ *
+ * The CrowMode dispatch in loop() needs the whole sketch: it is timed on a PC
+ * by crow-host's bench-dispatch (`make bench`), and in place by the mean and
+ * max loop times in animatronic-crow's 'r' session dump.
+ * The Cortex-M0+ has no performance counters, so branch counts are not
+ * reported; allocations are measured as the free heap change.
+ *
+ * Send 'b' to run the suite again.
+ *
+ * >> Shared headers are copies of animatronic-crow's <<
+ *
+ */
+#include <Arduino.h>
+#include <Servo.h>
+#include <DFRobotDFPlayerMini.h>
+#include <AccelStepper.h>
+#include "settings.h"
+#include "animations.h"
+#include "calibration.h"
+#include "crow-utils.h"
+#include "behavior.h"
+#include "scripts.h"
+
+// ============================================================================
+// BENCHMARK SETTINGS
+// ============================================================================
+#define BENCH_CALLS                   20000   // calls per benchmark
+#define BENCH_STEP_RATE_MS            1000    // runSpeed() sampling window
+
+// Limits (ns per call, 133MHz RP2040)
+#define LIMIT_ANIM_POS_NS             8000
+#define LIMIT_EASED_PWM_NS            8000
+#define LIMIT_HYDRATE_LUT_NS          15000000
+#define LIMIT_BLINKING_NS             2000
+#define LIMIT_UPDATE_BEAK_NS          20000
+#define LIMIT_SCRIPT_TICK_NS          2000
+#define LIMIT_STEPPER_RUN_NS          20000
+#define LIMIT_STEP_RATE_ERROR_PCT     2
+
+// Objects used by the shared headers
+AccelStepper stepper(AccelStepper::HALF4WIRE, PIN_STEPPER_1, PIN_STEPPER_3, PIN_STEPPER_2, PIN_STEPPER_4);
+Servo beakServo;
+DFRobotDFPlayerMini dfPlayer;
+
+volatile int benchSink = 0;
+bool benchPass = true;
+bool benchFirst = true;
+unsigned long benchRun = 0;
+
+void setup() {
+  Serial.begin(115200);
+  delay(7500);
+
+  pinMode(PIN_LED_EYES, OUTPUT);
+  runSuite();
+}
+
+void loop() {
+  if (Serial.available() > 0 && tolower(Serial.read()) == 'b') runSuite();
+}
+
+// ============================================================================
+// SUITE
+// ============================================================================
+
+void runSuite() {
+  benchPass = true;
+  benchFirst = true;
+  benchRun++;
+
+  Serial.print(F("{\"suite\":\"crow-bench\",\"run\":"));
+  Serial.print(benchRun);
+  Serial.print(F(",\"f_cpu\":"));
+  Serial.print(rp2040.f_cpu());
+  Serial.print(F(",\"results\":["));
+
+  benchAnimations();
+  benchHydrateLUT();
+  benchBlinking();
+  benchUpdateBeak();
+  benchScript();
+  benchStepper();
+
+  Serial.print(F("],\"pass\":"));
+  Serial.print(benchPass ? F("true") : F("false"));
+  Serial.println(F("}"));
+  Serial.println(benchPass ? F("BENCH PASS") : F("BENCH FAIL"));
+}
+
+// prints one result object and tracks the overall pass/fail
+void report(const char* name, int anim, unsigned long calls, unsigned long elapsedUs, int heapDelta, unsigned long limitNs) {
+  unsigned long ns = calls ? (unsigned long)((unsigned long long)elapsedUs * 1000 / calls) : 0;
+  bool pass = ns <= limitNs && heapDelta == 0;
+  if (!pass) benchPass = false;
+
+  if (!benchFirst) Serial.print(F(","));
+  benchFirst = false;
+  Serial.print(F("{\"name\":\""));
+  Serial.print(name);
+  if (anim > 0) {
+    Serial.print(F("/"));
+    Serial.print(anim);
+  }
+  Serial.print(F("\",\"ns_per_call\":"));
+  Serial.print(ns);
+  Serial.print(F(",\"calls\":"));
+  Serial.print(calls);
+  Serial.print(F(",\"alloc_bytes\":"));
+  Serial.print(heapDelta);
+  Serial.print(F(",\"limit_ns\":"));
+  Serial.print(limitNs);
+  Serial.print(F(",\"pass\":"));
+  Serial.print(pass ? F("true") : F("false"));
+  Serial.print(F("}"));
+}
+
+// ============================================================================
+// SCRIPT HOOKS (stand-ins: the benchmark times the interpreter only)
+// ============================================================================
+
+bool scriptIdle() { return true; }
+bool scriptSensor() { return false; }
+void scriptPlay(uint8_t track) { benchSink += track; }
+void scriptNeckSpeed(bool fast) { benchSink += fast; }
+void scriptNeck(int percent) { benchSink += percent; }
+void scriptNeckToward(uint8_t maxPercent) { benchSink += crowRandom(0, maxPercent + 1); }
+void scriptEyes(bool on) { benchSink += on; }
+
+// ============================================================================
+// BENCHMARKS
+// ============================================================================
+
+// plays every animation on a simulated 1ms clock until BENCH_CALLS are made
+void benchAnimations() {
+  unsigned long totalCalls = 0;
+  unsigned long totalUs = 0;
+  int totalHeap = 0;
+
+  for (uint8_t i = 0; i < NUM_ANIMATIONS; i++) {
+    const AnimKeyFrame* anim = (const AnimKeyFrame*)pgm_read_ptr(&(soundAnimations[i].animation));
+    uint8_t frames = pgm_read_byte(&(soundAnimations[i].numKeyframes));
+    uint16_t duration = pgm_read_word(&(anim[frames - 1].timeMs));
+
+    unsigned long calls = 0;
+    int heap = rp2040.getFreeHeap();
+    unsigned long start = micros();
+    while (calls < BENCH_CALLS) {
+      queuePendingAnimation(i, 0);
+      for (unsigned long t = 0; t <= duration; t++) {
+        benchSink += getEasedAnimPWMAt(t);
+        calls++;
+      }
+    }
+    unsigned long elapsed = micros() - start;
+    heap -= rp2040.getFreeHeap();
+    report("getEasedAnimPWM", i + 1, calls, elapsed, heap, LIMIT_EASED_PWM_NS);
+
+    totalCalls += calls;
+    totalUs += elapsed;
+    totalHeap += heap;
+  }
+  report("getEasedAnimPWM", 0, totalCalls, totalUs, totalHeap, LIMIT_EASED_PWM_NS);
+
+  // position only (no easing lookup)
+  uint16_t duration = pgm_read_word(&(anim_Scold5[sizeof(anim_Scold5) / sizeof(AnimKeyFrame) - 1].timeMs));
+  unsigned long calls = 0;
+  int heap = rp2040.getFreeHeap();
+  unsigned long start = micros();
+  while (calls < BENCH_CALLS) {
+    queuePendingAnimation(4, 0);
+    for (unsigned long t = 0; t <= duration; t++) {
+      benchSink += getAnimPosAt(t);
+      calls++;
+    }
+  }
+  unsigned long elapsed = micros() - start;
+  heap -= rp2040.getFreeHeap();
+  report("getAnimPos", 0, calls, elapsed, heap, LIMIT_ANIM_POS_NS);
+}
+
+void benchHydrateLUT() {
+  const unsigned long calls = 20;
+  int heap = rp2040.getFreeHeap();
+  unsigned long start = micros();
+  for (unsigned long i = 0; i < calls; i++) {
+    hydrateEasingLUT(SERVO_PWM_OPEN, SERVO_PWM_CLOSED, SERVO_EASING_FACTOR);
+  }
+  unsigned long elapsed = micros() - start;
+  heap -= rp2040.getFreeHeap();
+  report("hydrateEasingLUT", 0, calls, elapsed, heap, LIMIT_HYDRATE_LUT_NS);
+}
+
+// simulated clock advancing 100ms per call so both blink edges are exercised
+void benchBlinking() {
+  nextBlinkTime = 0;
+  int heap = rp2040.getFreeHeap();
+  unsigned long start = micros();
+  for (unsigned long t = 0; t < BENCH_CALLS; t++) {
+    handleBlinking(t * 100);
+  }
+  unsigned long elapsed = micros() - start;
+  heap -= rp2040.getFreeHeap();
+  report("handleBlinking", 0, BENCH_CALLS, elapsed, heap, LIMIT_BLINKING_NS);
+  digitalWrite(PIN_LED_EYES, LOW);
+}
+
+// real clock: a live animation with servo writes
+void benchUpdateBeak() {
+  hydrateEasingLUT(crowCal.pwmOpen, crowCal.pwmClosed, crowCal.easingFactor);
+  queuePendingAnimation(4, millis());
+  unsigned long calls = 0;
+  int heap = rp2040.getFreeHeap();
+  unsigned long start = micros();
+  while (calls < BENCH_CALLS) {
+    updateBeak();
+    calls++;
+  }
+  unsigned long elapsed = micros() - start;
+  heap -= rp2040.getFreeHeap();
+  report("updateBeak", 0, calls, elapsed, heap, LIMIT_UPDATE_BEAK_NS);
+  while (animating) updateBeak();
+  updateBeak(); // detach
+}
+
+// simulated 1ms clock: the script is always idle, so every wait is time only
+void benchScript() {
+  unsigned long calls = 0;
+  int heap = rp2040.getFreeHeap();
+  unsigned long start = micros();
+  while (calls < BENCH_CALLS) {
+    unsigned long t = millis();
+    scriptStart(scriptTryMe);
+    while (scriptUpdate(t++)) calls++;
+  }
+  unsigned long elapsed = micros() - start;
+  heap -= rp2040.getFreeHeap();
+  report("scriptUpdate", 0, calls, elapsed, heap, LIMIT_SCRIPT_TICK_NS);
+}
+
+void benchStepper() {
+  // scheduling cost of run() while accelerating/cruising
+  stepper.setCurrentPosition(0);
+  stepper.setMaxSpeed(NECK_SPEED_FAST_MAX);
+  stepper.setAcceleration(NECK_SPEED_FAST_ACCEL);
+  stepper.moveTo(1000000);
+  unsigned long calls = 0;
+  int heap = rp2040.getFreeHeap();
+  unsigned long start = micros();
+  while (calls < BENCH_CALLS) {
+    stepper.run();
+    calls++;
+  }
+  unsigned long elapsed = micros() - start;
+  heap -= rp2040.getFreeHeap();
+  report("AccelStepper::run", 0, calls, elapsed, heap, LIMIT_STEPPER_RUN_NS);
+
+  // step-rate accuracy at constant speed
+  stepper.setCurrentPosition(0);
+  stepper.setSpeed(NECK_SPEED_FAST_MAX);
+  calls = 0;
+  start = millis();
+  while (millis() - start < BENCH_STEP_RATE_MS) {
+    stepper.runSpeed();
+    calls++;
+  }
+  long expected = (long)NECK_SPEED_FAST_MAX * BENCH_STEP_RATE_MS / 1000;
+  long errorPct = labs(stepper.currentPosition() - expected) * 100 / expected;
+  bool pass = errorPct <= LIMIT_STEP_RATE_ERROR_PCT;
+  if (!pass) benchPass = false;
+  Serial.print(F(",{\"name\":\"AccelStepper::runSpeed\",\"steps\":"));
+  Serial.print(stepper.currentPosition());
+  Serial.print(F(",\"expected_steps\":"));
+  Serial.print(expected);
+  Serial.print(F(",\"calls\":"));
+  Serial.print(calls);
+  Serial.print(F(",\"error_pct\":"));
+  Serial.print(errorPct);
+  Serial.print(F(",\"limit_pct\":"));
+  Serial.print(LIMIT_STEP_RATE_ERROR_PCT);
+  Serial.print(F(",\"pass\":"));
+  Serial.print(pass ? F("true") : F("false"));
+  Serial.print(F("}"));
+
+  stepper.disableOutputs();
+}
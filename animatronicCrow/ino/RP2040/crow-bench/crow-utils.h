@@ -0,0 +1,66 @@
+#ifndef CROW_UTILS_H
+#define CROW_UTILS_H
+
+#include <Arduino.h>
+#include <Servo.h>
+#include <DFRobotDFPlayerMini.h>
+#include "settings.h"
+#include "animations.h"
+#include "calibration.h"
+#include "crow-random.h"
+
+// External objects defined in the main .ino
+extern Servo beakServo;
+extern DFRobotDFPlayerMini dfPlayer;
+
+static int lastSentPWM = -1;
+static unsigned long nextBlinkTime = 0;
+static bool eyesOpen = true;
+
+/**
+ * Handles the logic of attaching/detaching the servo and updating 
+ * its position (-1 detaches)
+ */
+bool writeBeak(int targetPWM) {
+  if (targetPWM != -1) {
+    if (targetPWM != lastSentPWM) {
+      beakServo.writeMicroseconds(targetPWM);
+      if (!beakServo.attached()) beakServo.attach(PIN_SERVO, crowCal.pwmOpen, crowCal.pwmClosed);
+      lastSentPWM = targetPWM;
+      return true;
+    }
+  } else if (beakServo.attached()) {
+    // Animation finished
+    beakServo.detach();
+    lastSentPWM = -1; 
+  }
+  return false;
+}
+
+bool updateBeak() {
+  return writeBeak(getEasedAnimPWM());
+}
+
+/**
+ * Random eye blinking: nextBlinkTime is the next eye change
+ * (close or reopen)
+ */
+void handleBlinking(unsigned long now) {
+  if (eyesOpen) {
+    // Check if it's time to blink
+    if (now >= nextBlinkTime) {
+      digitalWrite(PIN_LED_EYES, LOW);
+      eyesOpen = false;
+      nextBlinkTime = now + BLINK_DURATION_MS;
+    }
+  } else {
+    // Check if blink is complete
+    if (now >= nextBlinkTime) {
+      digitalWrite(PIN_LED_EYES, HIGH);
+      eyesOpen = true;
+      nextBlinkTime = now + crowRandom(BLINK_MIN_INTERVAL_MS, BLINK_MAX_INTERVAL_MS);
+    }
+  }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+// ****************************************************************************
+// Crow Benchmark Configuration (copy values from animatronic-crow/settings.h)
+// ****************************************************************************
+
+// ============================================================================
+// PIN DEFINITIONS - (defaults for CC5x12 v1.2 servo1, led1)
+// ============================================================================
+#define PIN_SERVO                     29    // SRV1 (2 on CC5x12 <= v1.1)
+#define PIN_LED_EYES                  14    // LED1
+// Stepper timing is measured on STEPPER2 so the neck does not move
+#define PIN_STEPPER_1                 9     // STEPPER2
+#define PIN_STEPPER_2                 10
+#define PIN_STEPPER_3                 11
+#define PIN_STEPPER_4                 12
+
+// Servo Settings
+#define SERVO_PWM_OPEN                1050  // fully open PWM
+#define SERVO_PWM_CLOSED              1250  // fully closed PWM
+#define SERVO_EASING_FACTOR           3.00  // determines animation smooting (smaller is smoother)
+#define SERVO_LAG_BASE_MS             0     // beak lag behind any move, ms (measure with calibrate-crow)
+#define SERVO_LAG_TRAVEL_MS           0     // added lag for a full open-close move, ms
+
+// Audio Settings
+#define DFPLAYER_VOLUME               25    // Volume 0-30
+#define AUDIO_SYNC_DELAY_MS           100   // sync delay
+
+// Idle Behavior Settings (used by scripts.h)
+#define IDLE_NECK_MIN_PERCENT         30    // Min percent of range for idle moves
+#define IDLE_NECK_MAX_PERCENT         100   // Max percent of range for idle moves
+
+// Eye Blink Settings
+#define BLINK_DURATION_MS             90    // How long eyes stay closed
+#define BLINK_MIN_INTERVAL_MS         3000  // Min time between blinks
+#define BLINK_MAX_INTERVAL_MS         8000  // Max time between blinks
+
+// Neck Movement Settings
+#define NECK_SPEED_SLOW_MAX           3250  // Slow movement max speed
+#define NECK_SPEED_SLOW_ACCEL         500   // Slow movement acceleration
+#define NECK_SPEED_FAST_MAX           6000  // Fast movement max speed
+#define NECK_SPEED_FAST_ACCEL         4000  // Fast movement acceleration
+#define NECK_RANGE_SCOLD_PERCENT        20  // Percent of range to move during scold (+/-)
+
+#endif
@@ -0,0 +1,147 @@
+// Host stand-in for AccelStepper: the library's own speed ramp (the same
+// computeNewSpeed() steps) against the simulated clock, with no pins.
+#ifndef HOST_ACCELSTEPPER_H
+#define HOST_ACCELSTEPPER_H
+
+#include <Arduino.h>
+
+class AccelStepper {
+public:
+  enum MotorInterfaceType { FUNCTION = 0, DRIVER = 1, FULL2WIRE = 2, FULL3WIRE = 3, FULL4WIRE = 4, HALF3WIRE = 6, HALF4WIRE = 8 };
+
+  unsigned long steps = 0; // steps taken, for tests
+  bool outputsEnabled = true;
+
+  AccelStepper(int = FULL4WIRE, int = 2, int = 3, int = 4, int = 5, bool = true) {}
+
+  void moveTo(long absolute) {
+    if (_targetPos == absolute) return;
+    _targetPos = absolute;
+    computeNewSpeed();
+  }
+  void move(long relative) { moveTo(_currentPos + relative); }
+
+  bool runSpeed() {
+    if (!_stepInterval) return false;
+    unsigned long time = micros();
+    if (time - _lastStepTime < _stepInterval) return false;
+    _currentPos += (_direction == DIRECTION_CW) ? 1 : -1;
+    steps++;
+    _lastStepTime = time;
+    return true;
+  }
+  bool run() {
+    if (runSpeed()) computeNewSpeed();
+    return _speed != 0.0f || distanceToGo() != 0;
+  }
+
+  void setMaxSpeed(float speed) {
+    if (speed < 0.0f) speed = -speed;
+    if (_maxSpeed == speed) return;
+    _maxSpeed = speed;
+    _cmin = 1000000.0f / speed;
+    if (_n > 0) {
+      _n = (long)((_speed * _speed) / (2.0f * _acceleration));
+      computeNewSpeed();
+    }
+  }
+  float maxSpeed() { return _maxSpeed; }
+  void setAcceleration(float acceleration) {
+    if (acceleration == 0.0f) return;
+    if (acceleration < 0.0f) acceleration = -acceleration;
+    if (_acceleration == acceleration) return;
+    _n = _n * (_acceleration / acceleration);
+    _c0 = 0.676f * sqrtf(2.0f / acceleration) * 1000000.0f;
+    _acceleration = acceleration;
+    computeNewSpeed();
+  }
+  void setSpeed(float speed) {
+    if (speed == _speed) return;
+    speed = constrain(speed, -_maxSpeed, _maxSpeed);
+    if (speed == 0.0f) {
+      _stepInterval = 0;
+    } else {
+      _stepInterval = (unsigned long)fabsf(1000000.0f / speed);
+      _direction = (speed > 0.0f) ? DIRECTION_CW : DIRECTION_CCW;
+    }
+    _speed = speed;
+  }
+  float speed() { return _speed; }
+  long distanceToGo() { return _targetPos - _currentPos; }
+  long targetPosition() { return _targetPos; }
+  long currentPosition() { return _currentPos; }
+  void setCurrentPosition(long position) {
+    _targetPos = _currentPos = position;
+    _n = 0;
+    _stepInterval = 0;
+    _speed = 0.0f;
+  }
+  void stop() {
+    if (_speed == 0.0f) return;
+    long stepsToStop = (long)((_speed * _speed) / (2.0f * _acceleration)) + 1;
+    move(_speed > 0 ? stepsToStop : -stepsToStop);
+  }
+  void disableOutputs() { outputsEnabled = false; }
+  void enableOutputs() { outputsEnabled = true; }
+  bool isRunning() { return !(_speed == 0.0f && _targetPos == _currentPos); }
+  void setEnablePin(int) {}
+  void runToPosition() {
+    while (run()) hostAdvance(_stepInterval ? _stepInterval : 1);
+  }
+
+private:
+  enum { DIRECTION_CCW = 0, DIRECTION_CW = 1 };
+
+  long _currentPos = 0;
+  long _targetPos = 0;
+  float _speed = 0.0f;
+  float _maxSpeed = 1.0f;
+  float _acceleration = 0.0f;
+  unsigned long _stepInterval = 0;
+  unsigned long _lastStepTime = 0;
+  long _n = 0;
+  float _c0 = 0.0f;
+  float _cn = 0.0f;
+  float _cmin = 1.0f;
+  bool _direction = DIRECTION_CCW;
+
+  void computeNewSpeed() {
+    long distanceTo = distanceToGo();
+    long stepsToStop = (long)((_speed * _speed) / (2.0f * _acceleration));
+
+    if (distanceTo == 0 && stepsToStop <= 1) {
+      _stepInterval = 0;
+      _speed = 0.0f;
+      _n = 0;
+      return;
+    }
+
+    if (distanceTo > 0) {
+      if (_n > 0) {
+        if ((stepsToStop >= distanceTo) || _direction == DIRECTION_CCW) _n = -stepsToStop;
+      } else if (_n < 0) {
+        if ((stepsToStop < distanceTo) && _direction == DIRECTION_CW) _n = -_n;
+      }
+    } else if (distanceTo < 0) {
+      if (_n > 0) {
+        if ((stepsToStop >= -distanceTo) || _direction == DIRECTION_CW) _n = -stepsToStop;
+      } else if (_n < 0) {
+        if ((stepsToStop < -distanceTo) && _direction == DIRECTION_CCW) _n = -_n;
+      }
+    }
+
+    if (_n == 0) {
+      _cn = _c0;
+      _direction = (distanceTo > 0) ? DIRECTION_CW : DIRECTION_CCW;
+    } else {
+      _cn = _cn - ((2.0f * _cn) / ((4.0f * _n) + 1));
+      _cn = max(_cn, _cmin);
+    }
+    _n++;
+    _stepInterval = (unsigned long)_cn;
+    _speed = 1000000.0f / _cn;
+    if (_direction == DIRECTION_CCW) _speed = -_speed;
+  }
+};
+
+#endif
@@ -0,0 +1,23 @@
+// Host stand-in for Adafruit_NeoPixel: one remembered color per strip
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+#include <Arduino.h>
+
+#define NEO_GRB     0x52
+#define NEO_KHZ800  0x0000
+
+class Adafruit_NeoPixel {
+public:
+  uint32_t color = 0;
+
+  Adafruit_NeoPixel(int, int, int) {}
+  void begin() {}
+  void setBrightness(int) {}
+  void setPixelColor(int, uint32_t c) { color = c; }
+  void show() {}
+  void clear() { color = 0; }
+  static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+};
+
+#endif
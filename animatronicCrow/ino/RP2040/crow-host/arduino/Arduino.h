@@ -0,0 +1,314 @@
+// ============================================================================
+// HOST ARDUINO CORE
+// ============================================================================
+// Just enough of the Arduino core (arduino-pico flavor) to build the crow's
+// headers and sketch on a PC. Time is simulated: micros() only moves when a
+// test advances it (hostAdvance(), delay(), or a sleep that waits for the
+// next timer, or hostReadCostUs per clock read so code that busy-waits on the
+// clock finishes), so every run is deterministic. unsigned long is 64 bits here,
+// so the ~49 day millis() wrap of the board cannot be reproduced.
+//
+// Pins are levels in hostPins[]; hostSetPin() changes one and runs its
+// interrupt handler like the hardware would. Serial output is kept in
+// Serial.out (and echoed to stdout when Serial.echo is set).
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef uint8_t pin_size_t;
+
+#define HIGH                  1
+#define LOW                   0
+#define INPUT                 0
+#define OUTPUT                1
+#define INPUT_PULLUP          2
+#define INPUT_PULLDOWN        3
+#define CHANGE                4
+#define RISING                5
+#define FALLING               6
+#define A0                    26
+#define A1                    27
+#define A2                    28
+#define A3                    29
+#define HOST_PINS             64
+
+#define PROGMEM
+#define F(x)                  (x)
+#define pgm_read_byte(p)      (*(const uint8_t*)(p))
+#define pgm_read_word(p)      (*(const uint16_t*)(p))
+#define pgm_read_dword(p)     (*(const uint32_t*)(p))
+#define pgm_read_ptr(p)       (*(void* const*)(p))
+#define pgm_read_float(p)     (*(const float*)(p))
+#define constrain(a, l, h)    ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+#define digitalPinToInterrupt(p) (p)
+
+// ============================================================================
+// CLOCK AND TIMERS
+// ============================================================================
+
+struct HostTimer {
+  int32_t id;
+  uint64_t atUs;
+  std::function<void()> fire;
+};
+
+inline uint64_t hostMicros = 0;
+inline std::vector<HostTimer> hostTimers;
+inline int32_t hostNextTimerId = 1;
+inline uint64_t hostReadCostUs = 0; // CPU time each millis()/micros() call takes
+
+inline unsigned long millis() {
+  hostMicros += hostReadCostUs;
+  return (unsigned long)(hostMicros / 1000);
+}
+inline unsigned long micros() {
+  hostMicros += hostReadCostUs;
+  return (unsigned long)hostMicros;
+}
+
+// runs fire at atUs (simulated); provides an id for hostCancel()
+inline int32_t hostAt(uint64_t atUs, std::function<void()> fire) {
+  hostTimers.push_back({hostNextTimerId, atUs, fire});
+  return hostNextTimerId++;
+}
+
+inline bool hostCancel(int32_t id) {
+  for (size_t i = 0; i < hostTimers.size(); i++) {
+    if (hostTimers[i].id != id) continue;
+    hostTimers.erase(hostTimers.begin() + i);
+    return true;
+  }
+  return false;
+}
+
+// fires the earliest timer due by untilUs; false if there is none
+inline bool hostFireNext(uint64_t untilUs) {
+  size_t next = hostTimers.size();
+  for (size_t i = 0; i < hostTimers.size(); i++) {
+    if (hostTimers[i].atUs > untilUs) continue;
+    if (next == hostTimers.size() || hostTimers[i].atUs < hostTimers[next].atUs) next = i;
+  }
+  if (next == hostTimers.size()) return false;
+  HostTimer t = hostTimers[next];
+  hostTimers.erase(hostTimers.begin() + next);
+  if (t.atUs > hostMicros) hostMicros = t.atUs;
+  t.fire();
+  return true;
+}
+
+// moves the clock forward, firing timers on the way
+inline void hostAdvance(uint64_t us) {
+  uint64_t until = hostMicros + us;
+  while (hostFireNext(until)) {}
+  hostMicros = until;
+}
+
+// WFI: sleeps until the next timer fires (1ms if none is set)
+inline void hostWaitForInterrupt() {
+  uint64_t next = hostMicros + 1000;
+  for (const HostTimer& t : hostTimers) {
+    if (t.atUs < next) next = t.atUs;
+  }
+  if (next < hostMicros) next = hostMicros;
+  hostAdvance(next - hostMicros);
+}
+
+inline void hostReset() {
+  hostMicros = 0;
+  hostTimers.clear();
+}
+
+inline void (*hostDelayHook)(unsigned long ms) = nullptr; // when set, delay() calls it instead
+
+inline void delay(unsigned long ms) {
+  if (hostDelayHook) hostDelayHook(ms);
+  else hostAdvance((uint64_t)ms * 1000);
+}
+inline void delayMicroseconds(unsigned int us) { hostAdvance(us); }
+inline void yield() {}
+
+// ============================================================================
+// PINS AND INTERRUPTS
+// ============================================================================
+
+inline int hostPins[HOST_PINS];
+inline int hostPinModes[HOST_PINS];
+inline int hostAnalog[HOST_PINS];
+inline void (*hostIsr[HOST_PINS])() = {};
+inline int hostIsrMode[HOST_PINS];
+
+inline void pinMode(int pin, int mode) {
+  hostPinModes[pin] = mode;
+  if (mode == INPUT_PULLUP) hostPins[pin] = HIGH;
+}
+inline void digitalWrite(int pin, int level) { hostPins[pin] = level ? HIGH : LOW; }
+inline int digitalRead(int pin) { return hostPins[pin]; }
+inline int analogRead(int pin) { return pin >= 0 && pin < HOST_PINS ? hostAnalog[pin] : 0; }  // -1: not wired
+
+inline void attachInterrupt(int pin, void (*isr)(), int mode) {
+  hostIsr[pin] = isr;
+  hostIsrMode[pin] = mode;
+}
+inline void detachInterrupt(int pin) { hostIsr[pin] = nullptr; }
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+// drives an input pin, running its interrupt handler on a matching edge
+inline void hostSetPin(int pin, int level) {
+  level = level ? HIGH : LOW;
+  if (hostPins[pin] == level) return;
+  hostPins[pin] = level;
+  if (hostIsr[pin] == nullptr) return;
+  int mode = hostIsrMode[pin];
+  if (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level)) hostIsr[pin]();
+}
+
+// ============================================================================
+// RANDOM
+// ============================================================================
+
+inline uint32_t hostRandomState = 1;
+
+inline void randomSeed(unsigned long seed) {
+  if (seed != 0) hostRandomState = seed;
+}
+inline long random(long howBig) {
+  if (howBig <= 0) return 0;
+  hostRandomState = hostRandomState * 1103515245UL + 12345UL;
+  return (hostRandomState >> 1) % howBig;
+}
+inline long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) return howSmall;
+  return random(howBig - howSmall) + howSmall;
+}
+
+// ============================================================================
+// SERIAL
+// ============================================================================
+
+class __FlashStringHelper;
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; i++) write(buf[i]);
+    return len;
+  }
+  virtual void flush() {}
+
+  size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(const std::string& s) { return write((const uint8_t*)s.data(), s.size()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int n, int base = 10) { return print((long)n, base); }
+  size_t print(unsigned int n, int base = 10) { return print((unsigned long)n, base); }
+  size_t print(long n, int base = 10) {
+    if (n < 0 && base == 10) return print('-') + print((unsigned long)-n, base);
+    return print((unsigned long)n, base);
+  }
+  size_t print(unsigned long n, int base = 10) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == 16 ? "%lX" : "%lu", n);
+    return print(buf);
+  }
+  size_t print(long long n, int base = 10) { return print((long)n, base); }
+  size_t print(unsigned long long n, int base = 10) { return print((unsigned long)n, base); }
+  size_t print(unsigned char n, int base = 10) { return print((unsigned long)n, base); }
+  size_t print(double d, int digits = 2) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*f", digits, d);
+    return print(buf);
+  }
+  template <typename T> size_t println(T v) { return print(v) + println(); }
+  template <typename T> size_t println(T v, int base) { return print(v, base) + println(); }
+  size_t println() { return print("\r\n"); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() { return -1; }
+  void setTimeout(unsigned long) {}
+};
+
+class HardwareSerial : public Stream {
+public:
+  std::string out;   // everything written
+  std::string in;    // bytes waiting to be read
+  bool echo = false; // also print to stdout
+
+  void begin(unsigned long) {}
+  void begin(unsigned long, int, int, int) {}
+  void end() {}
+  void setTX(int) {}
+  void setRX(int) {}
+  operator bool() { return true; }
+
+  using Print::write;
+  size_t write(uint8_t b) override {
+    out.push_back((char)b);
+    if (echo) fputc(b, stdout);
+    return 1;
+  }
+  int available() override { return (int)in.size(); }
+  int read() override {
+    if (in.empty()) return -1;
+    int b = (uint8_t)in[0];
+    in.erase(0, 1);
+    return b;
+  }
+  int peek() override { return in.empty() ? -1 : (uint8_t)in[0]; }
+};
+
+class SerialPIO : public HardwareSerial {
+public:
+  SerialPIO(int, int, size_t = 32) {}
+};
+
+inline HardwareSerial Serial;
+inline HardwareSerial Serial1;
+inline HardwareSerial Serial2;
+
+// ============================================================================
+// RP2040
+// ============================================================================
+
+inline bool hostRebootRequested = false;
+inline bool hostWatchdogStarted = false;
+inline uint64_t hostWatchdogFedUs = 0;
+
+class RP2040 {
+public:
+  void idleOtherCore() {}
+  void resumeOtherCore() {}
+  void restartCore1() {}
+  void wdt_begin(uint32_t) { hostWatchdogStarted = true; hostWatchdogFedUs = hostMicros; }
+  void wdt_reset() { hostWatchdogFedUs = hostMicros; }
+  void reboot() { hostRebootRequested = true; }
+  uint32_t getCycleCount() { return (uint32_t)(hostMicros * 133); }
+  uint32_t f_cpu() { return 133000000UL; }
+  int getFreeHeap() { return 200000; }
+  int getUsedHeap() { return 0; }
+  int getTotalHeap() { return 200000; }
+};
+
+inline RP2040 rp2040;
+
+#endif
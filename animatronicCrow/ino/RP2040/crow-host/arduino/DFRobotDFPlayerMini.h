@@ -0,0 +1,69 @@
+// Host stand-in for DFRobotDFPlayerMini: records what was played and lets
+// tests decide whether the player answers (hostDfPlayerOnline). Command
+// frames a sketch writes to Serial1 itself are answered through available()
+// the way the player would: a volume query with the volume, a reset with
+// the card coming online.
+#ifndef HOST_DFROBOTDFPLAYERMINI_H
+#define HOST_DFROBOTDFPLAYERMINI_H
+
+#include <Arduino.h>
+#include <deque>
+
+enum { TimeOut, WrongStack, DFPlayerCardInserted, DFPlayerCardRemoved, DFPlayerCardOnline, DFPlayerUSBInserted,
+       DFPlayerUSBRemoved, DFPlayerUSBOnline, DFPlayerPlayFinished, DFPlayerError, DFPlayerFeedBack };
+
+inline bool hostDfPlayerOnline = true;
+
+class DFRobotDFPlayerMini {
+public:
+  int volumeLevel = 0;
+  int lastTrack = 0;
+  unsigned long plays = 0;
+
+  bool begin(Stream&, bool = true, bool = true) { return hostDfPlayerOnline; }
+  void volume(uint8_t v) { volumeLevel = v; }
+  void play(int track) { lastTrack = track; plays++; }
+  void stop() {}
+  void reset() {}
+  int readVolume() { return hostDfPlayerOnline ? volumeLevel : -1; }
+  bool available() {
+    hostReadFrames();
+    if (replies.empty()) return false;
+    type = replies.front().type;
+    command = replies.front().command;
+    param = replies.front().param;
+    replies.pop_front();
+    return true;
+  }
+  uint8_t readType() { return type; }
+  uint16_t read() { return param; }
+  uint8_t readCommand() { return command; }
+  void setTimeOut(unsigned long) {}
+
+private:
+  struct Reply {
+    uint8_t type;
+    uint8_t command;
+    uint16_t param;
+  };
+  std::deque<Reply> replies;
+  size_t seen = 0;
+  uint8_t type = TimeOut;
+  uint8_t command = 0;
+  uint16_t param = 0;
+
+  void hostReadFrames() {
+    const std::string& out = Serial1.out;
+    for (; seen + 10 <= out.size(); seen += 10) {
+      const uint8_t* f = (const uint8_t*)out.data() + seen;
+      if (f[0] != 0x7E || f[9] != 0xEF) continue;
+      uint16_t value = f[5] << 8 | f[6];
+      if (f[3] == 0x06) volumeLevel = value;
+      if (!hostDfPlayerOnline) continue;
+      if (f[3] == 0x43) replies.push_back({DFPlayerFeedBack, 0x43, (uint16_t)volumeLevel});
+      if (f[3] == 0x0C) replies.push_back({DFPlayerCardOnline, 0x3F, 0x02});
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,36 @@
+// Host stand-in for the RP2040 EEPROM emulation: a byte array that tests
+// can inspect and corrupt (hostEeprom), counting commits.
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <Arduino.h>
+
+#define HOST_EEPROM_SIZE 4096
+
+inline uint8_t hostEeprom[HOST_EEPROM_SIZE];
+inline unsigned long hostEepromCommits = 0;
+
+class EEPROMClass {
+public:
+  size_t size = 0;
+
+  void begin(size_t bytes) { size = min(bytes, (size_t)HOST_EEPROM_SIZE); }
+  void end() {}
+  size_t length() { return size; }
+  uint8_t read(int address) { return hostEeprom[address]; }
+  void write(int address, uint8_t value) { hostEeprom[address] = value; }
+  bool commit() { hostEepromCommits++; return true; }
+
+  template <class T> T& get(int address, T& t) {
+    memcpy((void*)&t, &hostEeprom[address], sizeof(T));
+    return t;
+  }
+  template <class T> const T& put(int address, const T& t) {
+    memcpy(&hostEeprom[address], (const void*)&t, sizeof(T));
+    return t;
+  }
+};
+
+inline EEPROMClass EEPROM;
+
+#endif
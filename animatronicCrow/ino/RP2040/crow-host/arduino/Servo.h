@@ -0,0 +1,21 @@
+// Host stand-in for the Servo library: keeps the last pulse width
+#ifndef HOST_SERVO_H
+#define HOST_SERVO_H
+
+#include <Arduino.h>
+
+class Servo {
+public:
+  int pin = -1;
+  int us = 1500;
+  unsigned long writes = 0;
+
+  int attach(int p, int = 544, int = 2400) { pin = p; return 1; }
+  void detach() { pin = -1; }
+  bool attached() { return pin >= 0; }
+  void write(int angle) { writeMicroseconds(544 + (int)((2400L - 544) * angle / 180)); }
+  void writeMicroseconds(int value) { us = value; writes++; }
+  int readMicroseconds() { return us; }
+};
+
+#endif
@@ -0,0 +1,23 @@
+// Host stand-in for the Pico SDK's hardware/sync.h: WFI sleeps until the
+// next simulated timer, WFE returns at once (a spurious wake is always
+// allowed), and the counters show how often each was used.
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include <Arduino.h>
+
+inline unsigned long hostWfiCount = 0;
+inline unsigned long hostWfeCount = 0;
+inline unsigned long hostSevCount = 0;
+
+inline uint32_t save_and_disable_interrupts() { return 0; }
+inline void restore_interrupts(uint32_t) {}
+inline void __dmb() {}
+inline void __sev() { hostSevCount++; }
+inline void __wfe() { hostWfeCount++; }
+inline void __wfi() {
+  hostWfiCount++;
+  hostWaitForInterrupt();
+}
+
+#endif
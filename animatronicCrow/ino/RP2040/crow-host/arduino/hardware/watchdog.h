@@ -0,0 +1,11 @@
+// Host stand-in for the Pico SDK's hardware/watchdog.h
+#ifndef HOST_HARDWARE_WATCHDOG_H
+#define HOST_HARDWARE_WATCHDOG_H
+
+#include <Arduino.h>
+
+inline bool hostWatchdogCausedReboot = false;
+
+inline bool watchdog_enable_caused_reboot() { return hostWatchdogCausedReboot; }
+
+#endif
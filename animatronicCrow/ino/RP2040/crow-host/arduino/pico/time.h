@@ -0,0 +1,42 @@
+// Host stand-in for the Pico SDK's pico/time.h: alarms are simulated timers
+// (see Arduino.h), and every alarm pool shares them.
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+#include <Arduino.h>
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void* data);
+typedef uint64_t absolute_time_t;
+struct alarm_pool_t {};
+
+inline alarm_pool_t hostAlarmPool;
+inline unsigned long hostWfeTimeouts = 0;
+
+inline absolute_time_t get_absolute_time() { return hostMicros; }
+inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return hostMicros + (uint64_t)ms * 1000; }
+inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + (uint64_t)ms * 1000; }
+
+inline alarm_pool_t* alarm_pool_get_default() { return &hostAlarmPool; }
+inline alarm_pool_t* alarm_pool_create_with_unused_hardware_alarm(unsigned) { return &hostAlarmPool; }
+
+inline alarm_id_t alarm_pool_add_alarm_in_ms(alarm_pool_t*, uint32_t ms, alarm_callback_t callback, void* data, bool) {
+  int32_t id = hostNextTimerId;
+  return hostAt(hostMicros + (uint64_t)ms * 1000, [=]() { callback(id, data); });
+}
+
+inline alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void* data, bool fireIfPast) {
+  return alarm_pool_add_alarm_in_ms(&hostAlarmPool, ms, callback, data, fireIfPast);
+}
+
+inline bool alarm_pool_cancel_alarm(alarm_pool_t*, alarm_id_t id) { return hostCancel(id); }
+inline bool cancel_alarm(alarm_id_t id) { return hostCancel(id); }
+
+// the other core may need to run meanwhile, so the host never waits here:
+// it reports an event (a spurious wake) and the caller loops around
+inline bool best_effort_wfe_or_timeout(absolute_time_t) {
+  hostWfeTimeouts++;
+  return false;
+}
+
+#endif
@@ -0,0 +1,284 @@
+// ============================================================================
+// CROW DISPATCH BENCHMARK
+// ============================================================================
+// Times runCrow() (the CrowMode dispatch in loop(), or loop1() with
+// CORE_SPLIT) directly: the whole animatronic-crow sketch runs on the
+// simulated clock through BENCH_MINUTES of the same visitors, and each call
+// of the crow's loop is measured and counted under the mode it started in.
+// There are BENCH_RUNS runs, each in a fresh process (the sketch's statics
+// only start over with one), and every mode keeps its best run, which takes
+// most of the machine's noise out of the times. Where the kernel allows it,
+// the CPU's counters give instructions, branches and branch misses per call;
+// instructions do not depend on the machine's load, so they are what two
+// commits are compared on.
+//
+//   bench-dispatch                        prints one JSON line, exit 1 when a
+//                                         mode is over BENCH_LIMIT_NS per call
+//   bench-dispatch --baseline old.json    also exit 1 when a mode is more than
+//     [--tolerance pct]                   pct slower than in old.json:
+//                                         instructions per call when both runs
+//                                         counted them (BENCH_TOLERANCE_PCT),
+//                                         else ns (BENCH_TIME_TOLERANCE_PCT,
+//                                         and more than BENCH_NOISE_NS)
+//
+// The simulated clock's own work (timers, pin edges) is inside the measured
+// calls, as it is in the tests; it is the same for every commit. It is also
+// the only thing that allocates there, so heap use is left to crow-bench on
+// the board.
+#include "crow-sim.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define BENCH_MINUTES         30    // simulated minutes of visitors
+#define BENCH_RUNS            5     // the best run of each mode counts
+#define BENCH_SEED            7     // visitor schedule (as in `make replay`)
+#define BENCH_LIMIT_NS        20000 // per call, any mode (host build)
+#define BENCH_TOLERANCE_PCT   10    // allowed regression against --baseline (instructions)
+#define BENCH_TIME_TOLERANCE_PCT 25 // the same without counters (times are noisier)
+#define BENCH_NOISE_NS        20    // ...and only a slowdown of more than this counts
+
+static const char* const benchModeNames[] = {"idle", "idle_move", "scolding", "squawking", "resetting"};
+#define BENCH_MODES           (sizeof(benchModeNames) / sizeof(benchModeNames[0]))
+
+struct BenchMode {
+  unsigned long long calls;
+  unsigned long long ns;
+  unsigned long long maxNs;
+  unsigned long long instructions;
+  unsigned long long branches;
+  unsigned long long branchMisses;
+};
+
+static BenchMode benchModes[BENCH_MODES];  // this run
+static BenchMode benchBest[BENCH_MODES];
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+
+// instructions, branches, branch misses in one group (leader first)
+static int benchCounterFd = -1;
+
+struct BenchCounters {
+  uint64_t count;
+  uint64_t values[3];
+};
+
+static bool benchOpenCounters() {
+  const uint64_t configs[3] = {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES};
+  for (int i = 0; i < 3; i++) {
+    perf_event_attr attr = {};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = configs[i];
+    attr.disabled = i == 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    int fd = syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : benchCounterFd, 0);
+    if (fd < 0) {
+      if (benchCounterFd >= 0) close(benchCounterFd);
+      benchCounterFd = -1;
+      return false;
+    }
+    if (i == 0) benchCounterFd = fd;
+  }
+  ioctl(benchCounterFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+}
+
+static void benchRead(BenchCounters& c) {
+  if (benchCounterFd < 0 || read(benchCounterFd, &c, sizeof(c)) != sizeof(c)) c = {};
+}
+
+static unsigned long long benchNowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// what measuring an empty call costs, taken off every measured call
+static unsigned long long benchOverheadNs = 0;
+static uint64_t benchOverhead[3] = {};
+
+static void benchCalibrate() {
+  const int rounds = 10000;
+  BenchCounters a, b;
+  unsigned long long ns = 0;
+  uint64_t counts[3] = {};
+  for (int i = 0; i < rounds; i++) {
+    benchRead(a);
+    unsigned long long start = benchNowNs();
+    unsigned long long end = benchNowNs();
+    benchRead(b);
+    ns += end - start;
+    for (int k = 0; k < 3; k++) counts[k] += b.values[k] - a.values[k];
+  }
+  benchOverheadNs = ns / rounds;
+  for (int k = 0; k < 3; k++) benchOverhead[k] = counts[k] / rounds;
+}
+
+static uint8_t benchMode;
+static BenchCounters benchBefore;
+static unsigned long long benchStartNs;
+
+static unsigned long long benchLess(unsigned long long value, unsigned long long overhead) {
+  return value > overhead ? value - overhead : 0;
+}
+
+static void benchProbe(bool begin) {
+  if (begin) {
+    if (Serial.out.size() > (1 << 20)) Serial.out.clear();
+    benchMode = currentMode < BENCH_MODES ? currentMode : 0;
+    benchRead(benchBefore);
+    benchStartNs = benchNowNs();
+    return;
+  }
+  unsigned long long ns = benchLess(benchNowNs() - benchStartNs, benchOverheadNs);
+  BenchCounters after;
+  benchRead(after);
+  BenchMode& m = benchModes[benchMode];
+  m.calls++;
+  m.ns += ns;
+  m.maxNs = max(m.maxNs, ns);
+  m.instructions += benchLess(after.values[0] - benchBefore.values[0], benchOverhead[0]);
+  m.branches += benchLess(after.values[1] - benchBefore.values[1], benchOverhead[1]);
+  m.branchMisses += benchLess(after.values[2] - benchBefore.values[2], benchOverhead[2]);
+}
+
+// ============================================================================
+// BASELINE
+// ============================================================================
+
+struct BenchBaseline {
+  bool counters = false;
+  double perCall[BENCH_MODES] = {};   // instructions, or ns without counters
+};
+
+// reads the JSON line an earlier run printed (only the fields compared)
+static bool benchReadBaseline(const char* path, BenchBaseline& b, bool counters) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "bench-dispatch: cannot open %s\n", path);
+    return false;
+  }
+  std::string json;
+  char buffer[4096];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) json.append(buffer, n);
+  fclose(f);
+  b.counters = counters && json.find("\"counters\":true") != std::string::npos;
+  const char* key = b.counters ? "\"instructions\":" : "\"ns\":";
+  for (size_t m = 0; m < BENCH_MODES; m++) {
+    std::string name = std::string("{\"mode\":\"") + benchModeNames[m] + "\"";
+    size_t at = json.find(name);
+    if (at == std::string::npos) continue;
+    at = json.find(key, at);
+    if (at != std::string::npos) b.perCall[m] = atof(json.c_str() + at + strlen(key));
+  }
+  return true;
+}
+
+// ============================================================================
+// RUN
+// ============================================================================
+
+// one run in a child process (which opens its own counters), its results in
+// benchModes
+static bool benchRun(bool& counters) {
+  int results[2];
+  if (pipe(results) != 0) return false;
+  fflush(stdout);
+  pid_t child = fork();
+  if (child < 0) return false;
+  if (child == 0) {
+    close(results[0]);
+    counters = benchOpenCounters();
+    benchCalibrate();
+    simBoot(BENCH_SEED);
+    uint64_t end = hostMicros + BENCH_MINUTES * 60000000ULL;
+    simVisitors(BENCH_SEED, end);
+    simCrowProbe = benchProbe;
+    simRun(end);
+    bool sent = write(results[1], &counters, sizeof(counters)) == sizeof(counters) &&
+                write(results[1], benchModes, sizeof(benchModes)) == sizeof(benchModes);
+    _exit(sent ? 0 : 1);
+  }
+  close(results[1]);
+  bool received = read(results[0], &counters, sizeof(counters)) == sizeof(counters) &&
+                  read(results[0], benchModes, sizeof(benchModes)) == sizeof(benchModes);
+  close(results[0]);
+  int status;
+  waitpid(child, &status, 0);
+  return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char** argv) {
+  const char* baselinePath = nullptr;
+  double tolerance = -1;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baselinePath = argv[++i];
+    } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+      tolerance = atof(argv[++i]);
+    } else {
+      fprintf(stderr, "usage: bench-dispatch [--baseline old.json] [--tolerance pct]\n");
+      return 2;
+    }
+  }
+
+  bool counters = true;
+  for (int run = 0; run < BENCH_RUNS; run++) {
+    bool counted = false;
+    if (!benchRun(counted)) {
+      fprintf(stderr, "bench-dispatch: run %d failed\n", run + 1);
+      return 2;
+    }
+    counters = counters && counted;
+    for (size_t i = 0; i < BENCH_MODES; i++) {
+      BenchMode& best = benchBest[i];
+      if (run == 0 || benchModes[i].ns < best.ns) best = benchModes[i];
+    }
+  }
+
+  BenchBaseline baseline;
+  if (baselinePath && !benchReadBaseline(baselinePath, baseline, counters)) return 2;
+  if (tolerance < 0) tolerance = baseline.counters ? BENCH_TOLERANCE_PCT : BENCH_TIME_TOLERANCE_PCT;
+
+  bool pass = true;
+  printf("{\"bench\":\"dispatch\",\"minutes\":%d,\"runs\":%d,\"seed\":%d,\"sensor_mode\":%d,\"core_split\":%d,\"counters\":%s,"
+         "\"modes\":[",
+         BENCH_MINUTES, BENCH_RUNS, BENCH_SEED, SENSOR_MODE, CORE_SPLIT ? 1 : 0, counters ? "true" : "false");
+  bool first = true;
+  for (size_t i = 0; i < BENCH_MODES; i++) {
+    const BenchMode& m = benchBest[i];
+    if (m.calls == 0) continue;
+    double ns = (double)m.ns / m.calls;
+    double instructions = (double)m.instructions / m.calls;
+    bool modePass = ns <= BENCH_LIMIT_NS;
+    double was = baseline.perCall[i];
+    double now = baseline.counters ? instructions : ns;
+    double slack = baseline.counters ? 0 : BENCH_NOISE_NS;
+    if (was > 0 && now > was * (1 + tolerance / 100) && now > was + slack) modePass = false;
+    pass = pass && modePass;
+
+    printf("%s{\"mode\":\"%s\",\"calls\":%llu,\"ns\":%.1f,\"max_ns\":%llu", first ? "" : ",", benchModeNames[i], m.calls,
+           ns, m.maxNs);
+    if (counters) {
+      printf(",\"instructions\":%.1f,\"branches\":%.1f,\"branch_misses\":%.2f", instructions,
+             (double)m.branches / m.calls, (double)m.branchMisses / m.calls);
+    }
+    printf(",\"limit_ns\":%d", BENCH_LIMIT_NS);
+    if (was > 0) printf(",\"baseline\":%.1f", was);
+    printf(",\"pass\":%s}", modePass ? "true" : "false");
+    first = false;
+  }
+  printf("]}\n");
+  printf(pass ? "BENCH PASS\n" : "BENCH FAIL\n");
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+// ============================================================================
+// BEHAVIOR SCRIPT BENCHMARK
+// ============================================================================
+// Times scriptUpdate() per loop tick, the interpreter alone: every script in
+// scripts.h (and a looping one) runs BENCH_REPEATS times on the simulated
+// clock, one scriptUpdate() call every BENCH_TICK_US, with hooks that only
+// keep the crow "busy" as long as a beak animation or a neck move would.
+// Calls that run instructions (steps) are counted apart from the ones that
+// only find the script still waiting. There are BENCH_RUNS runs with the same
+// random seed, and every script keeps its best run.
+//
+//   bench-script     prints one JSON line, exit 1 when a script is over
+//                    BENCH_LIMIT_NS per call
+//
+// `make bench` runs it after bench-dispatch, which times the loop around it.
+#include "crow-host.h"
+#include "settings.h"
+#include "behavior.h"
+#include "scripts.h"
+
+#include <time.h>
+
+#define BENCH_RUNS            5     // the best run of each script counts
+#define BENCH_REPEATS         20    // script runs per bench run
+#define BENCH_SEED            7     // crowRandom() (as in bench-dispatch)
+#define BENCH_TICK_US         100   // one pass of the crow's loop
+#define BENCH_LIMIT_NS        2000  // per call, any script (host build)
+#define BENCH_PLAY_MS         1500  // a beak animation
+#define BENCH_NECK_MS         600   // a neck move
+#define BENCH_LOOPS           5     // passes of benchLoop before the sensor goes high
+
+// plays until the sensor goes high, with a chance of a second squawk
+static constexpr uint8_t benchLoop[] PROGMEM = {
+  S_EYES(1),
+  S_LABEL(1),
+  S_PLAY(8, 14),
+  S_CHANCE(50, 2),
+  S_PLAY(8, 14),
+  S_LABEL(2),
+  S_WAIT_IDLE,
+  S_WAIT(100),
+  S_IF_SENSOR(3),
+  S_JUMP(1),
+  S_LABEL(3),
+  S_EYES(0),
+  S_END
+};
+SCRIPT_CHECK(benchLoop);
+
+struct BenchScript {
+  const char* name;
+  const uint8_t* code;
+  unsigned long long calls;
+  unsigned long long ns;
+  unsigned long long maxNs;
+  unsigned long long steps;    // calls that ran instructions
+  unsigned long long stepNs;
+};
+
+static BenchScript benchScripts[] = {
+  {"scold", scriptScold},
+  {"squawk", scriptSquawk},
+  {"idle_move", scriptIdleMove},
+  {"try_me", scriptTryMe},
+  {"loop", benchLoop},
+};
+#define BENCH_SCRIPTS         (sizeof(benchScripts) / sizeof(benchScripts[0]))
+
+static BenchScript benchBest[BENCH_SCRIPTS];
+
+// ============================================================================
+// HOOKS
+// ============================================================================
+
+static uint64_t benchBusyUntil = 0;
+static int benchPlays = 0;
+
+static void benchBusy(unsigned long ms) {
+  uint64_t until = hostMicros + ms * 1000ULL;
+  if (until > benchBusyUntil) benchBusyUntil = until;
+}
+
+bool scriptIdle() { return hostMicros >= benchBusyUntil; }
+bool scriptSensor() { return benchPlays >= BENCH_LOOPS; }
+void scriptPlay(uint8_t) { benchPlays++; benchBusy(BENCH_PLAY_MS); }
+void scriptNeckSpeed(bool) {}
+void scriptNeck(int) { benchBusy(BENCH_NECK_MS); }
+void scriptNeckToward(uint8_t) { benchBusy(BENCH_NECK_MS); }
+void scriptEyes(bool) {}
+
+// ============================================================================
+// MEASUREMENT
+// ============================================================================
+
+static unsigned long long benchNowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// what measuring an empty call costs, taken off every measured call
+static unsigned long long benchOverheadNs = 0;
+
+static void benchCalibrate() {
+  const int rounds = 10000;
+  unsigned long long ns = 0;
+  for (int i = 0; i < rounds; i++) {
+    unsigned long long start = benchNowNs();
+    ns += benchNowNs() - start;
+  }
+  benchOverheadNs = ns / rounds;
+}
+
+// runs script to its end BENCH_REPEATS times, one timed call per tick
+static void benchRun(BenchScript& s) {
+  s.calls = s.ns = s.maxNs = s.steps = s.stepNs = 0;
+  for (int i = 0; i < BENCH_REPEATS; i++) {
+    benchBusyUntil = 0;
+    benchPlays = 0;
+    bool running = true;
+    for (bool first = true; running; first = false) {
+      uint16_t pc = scriptPc;
+      unsigned long now = millis();
+      unsigned long long start = benchNowNs();
+      if (first) {
+        scriptStart(s.code);  // its first scriptUpdate() runs up to the first wait
+        running = scriptRunning();
+      } else {
+        running = scriptUpdate(now);
+      }
+      unsigned long long ns = benchNowNs() - start;
+      ns = ns > benchOverheadNs ? ns - benchOverheadNs : 0;
+      s.calls++;
+      s.ns += ns;
+      s.maxNs = max(s.maxNs, ns);
+      if (first || scriptPc != pc || !running) {
+        s.steps++;
+        s.stepNs += ns;
+      }
+      hostAdvance(BENCH_TICK_US);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc != 1) {
+    fprintf(stderr, "usage: bench-script\n");
+    return 2;
+  }
+  hostReset();
+  benchCalibrate();
+  for (int run = 0; run < BENCH_RUNS; run++) {
+    crowRandomSeed(BENCH_SEED);
+    for (size_t i = 0; i < BENCH_SCRIPTS; i++) {
+      benchRun(benchScripts[i]);
+      if (run == 0 || benchScripts[i].ns < benchBest[i].ns) benchBest[i] = benchScripts[i];
+    }
+  }
+
+  bool pass = true;
+  printf("{\"bench\":\"script\",\"runs\":%d,\"repeats\":%d,\"seed\":%d,\"tick_us\":%d,\"scripts\":[", BENCH_RUNS,
+         BENCH_REPEATS, BENCH_SEED, BENCH_TICK_US);
+  for (size_t i = 0; i < BENCH_SCRIPTS; i++) {
+    const BenchScript& s = benchBest[i];
+    double ns = s.calls ? (double)s.ns / s.calls : 0;
+    bool scriptPass = ns <= BENCH_LIMIT_NS;
+    pass = pass && scriptPass;
+    printf("%s{\"script\":\"%s\",\"calls\":%llu,\"ns\":%.1f,\"max_ns\":%llu,\"steps\":%llu,\"step_ns\":%.1f,"
+           "\"limit_ns\":%d,\"pass\":%s}",
+           i ? "," : "", s.name, s.calls, ns, s.maxNs, s.steps, s.steps ? (double)s.stepNs / s.steps : 0,
+           BENCH_LIMIT_NS, scriptPass ? "true" : "false");
+  }
+  printf("]}\n");
+  printf(pass ? "BENCH PASS\n" : "BENCH FAIL\n");
+  return pass ? 0 : 1;
+}
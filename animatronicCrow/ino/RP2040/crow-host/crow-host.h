@@ -0,0 +1,61 @@
+// ============================================================================
+// CROW HOST TESTS
+// ============================================================================
+// Shared by the host tests and tools: the mode codes the sketch defines
+// before including settings.h, and a minimal CHECK harness. Each test
+// prints its failures and exits non-zero so `make test` stops on them.
+#ifndef CROW_HOST_H
+#define CROW_HOST_H
+
+#include <Arduino.h>
+
+// SENSOR MODE CODES - as in animatronic-crow.ino
+#define SENSOR_MODE_PIR 0
+#define SENSOR_MODE_LD1020 1
+#define SENSOR_MODE_NONE 2
+#define SENSOR_MODE_BUTTON 3
+
+// FLOCK MODE CODES - as in animatronic-crow.ino
+#define FLOCK_MODE_OFF 0
+#define FLOCK_MODE_LEADER 1
+#define FLOCK_MODE_FOLLOWER 2
+
+inline int hostChecks = 0;
+inline int hostFailures = 0;
+
+#define CHECK(cond) \
+  do { \
+    hostChecks++; \
+    if (!(cond)) { \
+      hostFailures++; \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    hostChecks++; \
+    long long _a = (long long)(a), _b = (long long)(b); \
+    if (_a != _b) { \
+      hostFailures++; \
+      fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+  do { \
+    hostChecks++; \
+    double _a = (double)(a), _b = (double)(b); \
+    if (fabs(_a - _b) > (tolerance)) { \
+      hostFailures++; \
+      fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, _a, _b); \
+    } \
+  } while (0)
+
+// prints the summary line; the return value is the process exit code
+inline int hostReport(const char* name) {
+  printf("%-18s %4d checks, %d failed\n", name, hostChecks, hostFailures);
+  return hostFailures ? 1 : 0;
+}
+
+#endif
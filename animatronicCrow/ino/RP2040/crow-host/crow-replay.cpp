@@ -0,0 +1,242 @@
+// ============================================================================
+// CROW REPLAY
+// ============================================================================
+// Replays a session the crow recorded (send 'r' on the Serial Monitor, save
+// the output) against this tree's animatronic-crow sketch on the simulated
+// clock. It restores the oldest checkpoint whose inputs are all still in the
+// dump, feeds the sensor/button inputs back at their recorded times and
+// compares every recorded output (mode transition or track played) with the
+// replayed one.
+//
+//   crow-replay session.txt             exit 0 when every output matches, 1 at
+//                                       the first one that differs
+//   crow-replay --record <min> [seed]   runs the crow for <min> simulated
+//                                       minutes of random visitors and prints
+//                                       its dump (for the round-trip test)
+//
+// The sketch must be built with the settings the session was recorded with
+// (the dump's session line carries SENSOR_MODE and CORE_SPLIT). Tracking
+// edges and flock traffic are not recorded.
+#include "crow-sim.h"
+
+#define REPLAY_TAIL_MS        1000  // keep running this long past the last event
+
+struct ReplayEvent {
+  uint32_t n;
+  uint32_t timeMs;
+  uint8_t type;   // RecordType
+  uint8_t a;      // mode: from
+  uint8_t b;      // input: level, mode: to, track: track
+};
+
+struct Session {
+  int sensorMode = -1;
+  int split = -1;
+  std::vector<RecordCheckpoint> checkpoints;
+  std::vector<ReplayEvent> inputs;
+  std::vector<ReplayEvent> outputs;
+};
+
+static bool readSession(const char* path, Session& s) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "crow-replay: cannot open %s\n", path);
+    return false;
+  }
+  char line[256];
+  bool ended = false;
+  while (fgets(line, sizeof(line), f)) {
+    int version;
+    unsigned long seed;
+    RecordCheckpoint c;
+    long v[11];
+    unsigned long n, t, a, b;
+    if (sscanf(line, "session %d %d %d %lu", &version, &s.sensorMode, &s.split, &seed) == 4) {
+      if (version != RECORD_DUMP_VERSION) {
+        fprintf(stderr, "crow-replay: session version %d, expected %d\n", version, RECORD_DUMP_VERSION);
+        fclose(f);
+        return false;
+      }
+    } else if (sscanf(line, "checkpoint %lu %lu %lu %lu %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld %ld",
+                      &t, &n, &a, &b, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10]) == 15) {
+      c.timeMs = t;
+      c.inputs = n;
+      c.outputs = a;
+      c.state = {(uint32_t)b, (int32_t)v[0], (int32_t)v[1], (int32_t)v[2], (int32_t)v[3], (int32_t)v[4], (int32_t)v[5],
+                 (int32_t)v[6], (uint8_t)v[7], (uint8_t)v[8], (uint8_t)v[9], (uint8_t)v[10]};
+      s.checkpoints.push_back(c);
+    } else if (sscanf(line, "input %lu %lu %lu %lu", &n, &t, &a, &b) == 4) {
+      s.inputs.push_back({(uint32_t)n, (uint32_t)t, (uint8_t)a, 0, (uint8_t)b});
+    } else if (sscanf(line, "mode %lu %lu %lu %lu", &n, &t, &a, &b) == 4) {
+      s.outputs.push_back({(uint32_t)n, (uint32_t)t, REC_MODE, (uint8_t)a, (uint8_t)b});
+    } else if (sscanf(line, "track %lu %lu %lu", &n, &t, &b) == 3) {
+      s.outputs.push_back({(uint32_t)n, (uint32_t)t, REC_TRACK, 0, (uint8_t)b});
+    } else if (strncmp(line, "end", 3) == 0) {
+      ended = true;
+    }
+  }
+  fclose(f);
+  if (s.sensorMode < 0 || !ended || s.checkpoints.empty()) {
+    fprintf(stderr, "crow-replay: %s is not a complete session dump\n", path);
+    return false;
+  }
+  return true;
+}
+
+// the oldest checkpoint whose inputs (and if possible outputs) are all kept
+static const RecordCheckpoint* startingPoint(const Session& s) {
+  uint32_t firstInput = s.inputs.empty() ? 0 : s.inputs.front().n;
+  uint32_t firstOutput = s.outputs.empty() ? 0 : s.outputs.front().n;
+  const RecordCheckpoint* usable = nullptr;
+  for (const RecordCheckpoint& c : s.checkpoints) {
+    if (c.inputs < firstInput) continue;
+    if (c.outputs >= firstOutput) return &c;
+    if (!usable) usable = &c;
+  }
+  return usable;
+}
+
+static void applyInput(const ReplayEvent& e) {
+  if (e.type == REC_SENSOR) {
+    hostSetPin(PIN_MOTION_SENSOR, e.b);
+    sensorCurrentlyHigh = e.b;
+  } else if (e.type == REC_BUTTON) {
+    buttonTriggered = true;
+    powerSensorEdge();  // the press was a pin edge, which wakes the crow
+  }
+}
+
+static void printModeTimes(const char* label, const std::vector<ReplayEvent>& outputs, uint32_t startMs, uint32_t endMs,
+                           uint8_t startMode) {
+  unsigned long ms[RECORD_MAX_MODES] = {};
+  uint32_t since = startMs;
+  uint8_t mode = startMode;
+  for (const ReplayEvent& e : outputs) {
+    if (e.type != REC_MODE) continue;
+    if (mode < RECORD_MAX_MODES) ms[mode] += e.timeMs - since;
+    since = e.timeMs;
+    mode = e.b;
+  }
+  if (mode < RECORD_MAX_MODES && endMs > since) ms[mode] += endMs - since;
+  printf("[Replay] %-9s", label);
+  for (uint8_t m = 0; m < RECORD_MAX_MODES; m++) {
+    if (ms[m]) printf(" %u=%lums", m, ms[m]);
+  }
+  printf("\n");
+}
+
+static void printOutput(const ReplayEvent& e) {
+  if (e.type == REC_MODE) printf("mode %u->%u", e.a, e.b);
+  else printf("track %u", e.b);
+}
+
+static int replay(const char* path) {
+  Session s;
+  if (!readSession(path, s)) return 2;
+  if (s.sensorMode != SENSOR_MODE || s.split != (CORE_SPLIT ? 1 : 0)) {
+    fprintf(stderr, "crow-replay: recorded with SENSOR_MODE %d CORE_SPLIT %d, built with %d %d\n",
+            s.sensorMode, s.split, SENSOR_MODE, CORE_SPLIT ? 1 : 0);
+    return 2;
+  }
+  const RecordCheckpoint* start = startingPoint(s);
+  if (!start) {
+    fprintf(stderr, "crow-replay: no checkpoint has all of its inputs in the dump\n");
+    return 2;
+  }
+  printf("[Replay] %zu checkpoints, %zu inputs, %zu outputs; starting at %lums (input #%lu, output #%lu)\n",
+         s.checkpoints.size(), s.inputs.size(), s.outputs.size(), (unsigned long)start->timeMs,
+         (unsigned long)start->inputs, (unsigned long)start->outputs);
+
+  simBoot(0);
+  uint64_t resumeUs = (uint64_t)recordClock(start->timeMs) * 1000;
+  if (resumeUs > hostMicros) hostAdvance(resumeUs - hostMicros);
+  recordResume(*start);
+
+  uint32_t endMs = start->timeMs;
+  for (const ReplayEvent& e : s.inputs) {
+    if (e.n < start->inputs) continue;
+    hostAt((uint64_t)recordClock(e.timeMs) * 1000, [e]() { applyInput(e); });
+    endMs = max(endMs, e.timeMs);
+  }
+  std::vector<ReplayEvent> expected;
+  for (const ReplayEvent& e : s.outputs) {
+    if (e.n < start->outputs) continue;
+    expected.push_back(e);
+    endMs = max(endMs, e.timeMs);
+  }
+  simRun((uint64_t)recordClock(endMs + REPLAY_TAIL_MS) * 1000);
+
+  // the replay's own output log, numbered like the recording's
+  std::vector<ReplayEvent> replayed;
+  uint32_t first = recordOutputCount > RECORD_OUTPUTS ? recordOutputCount - RECORD_OUTPUTS : 0;
+  for (uint32_t n = max(first, start->outputs); n < recordOutputCount; n++) {
+    const RecordEvent& e = recordOutputLog[n % RECORD_OUTPUTS];
+    replayed.push_back({n, e.timeMs, e.type, (uint8_t)e.value, e.arg});
+  }
+
+  long maxSkew = 0;
+  long long totalSkew = 0;
+  size_t matched = 0;
+  for (const ReplayEvent& want : expected) {
+    const ReplayEvent* got = nullptr;
+    for (const ReplayEvent& r : replayed) {
+      if (r.n == want.n) got = &r;
+    }
+    if (!got || got->type != want.type || got->a != want.a || got->b != want.b) {
+      printf("[Replay] ✗ Diverged at output #%lu (%lums): expected ", (unsigned long)want.n,
+             (unsigned long)want.timeMs);
+      printOutput(want);
+      printf(", ");
+      if (got) {
+        printf("got ");
+        printOutput(*got);
+        printf(" at %lums\n", (unsigned long)got->timeMs);
+      } else {
+        printf("got nothing\n");
+      }
+      return 1;
+    }
+    long skew = (long)got->timeMs - (long)want.timeMs;
+    maxSkew = max(maxSkew, labs(skew));
+    totalSkew += labs(skew);
+    matched++;
+  }
+  printf("[Replay] ✓ %zu outputs matched (skew max %ldms, mean %.1fms)\n", matched, maxSkew,
+         matched ? (double)totalSkew / matched : 0.0);
+  uint32_t lastMs = expected.empty() ? endMs : expected.back().timeMs;
+  std::vector<ReplayEvent> replayedUpTo;
+  for (const ReplayEvent& r : replayed) {
+    if (r.n <= (expected.empty() ? 0 : expected.back().n)) replayedUpTo.push_back(r);
+  }
+  printModeTimes("recorded", expected, start->timeMs, lastMs, start->state.mode);
+  printModeTimes("replayed", replayedUpTo, start->timeMs, replayedUpTo.empty() ? lastMs : replayedUpTo.back().timeMs,
+                 start->state.mode);
+  return 0;
+}
+
+// ============================================================================
+// RECORDING (round-trip test)
+// ============================================================================
+
+static int record(unsigned long minutes, uint32_t seed) {
+  simBoot(seed % 4096);
+  uint64_t end = hostMicros + minutes * 60000000ULL;
+  simVisitors(seed, end);
+  simRun(end);
+
+  size_t from = Serial.out.size();
+  recordDump();
+  fwrite(Serial.out.data() + from, 1, Serial.out.size() - from, stdout);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc >= 3 && strcmp(argv[1], "--record") == 0) {
+    return record(strtoul(argv[2], nullptr, 10), argc > 3 ? strtoul(argv[3], nullptr, 10) : 1);
+  }
+  if (argc != 2) {
+    fprintf(stderr, "usage: crow-replay session.txt | crow-replay --record <minutes> [seed]\n");
+    return 2;
+  }
+  return replay(argv[1]);
+}
@@ -0,0 +1,86 @@
+// ============================================================================
+// CROW SIMULATOR
+// ============================================================================
+// Runs the whole animatronic-crow sketch on the simulated clock: the Makefile
+// turns the .ino into build/animatronic-crow.cpp (ino2cpp.py) and a tool
+// includes this header once. Both cores' loops take turns, each turn costing
+// at least SIM_LOOP_US, and every clock read costs a microsecond so the
+// sketch's busy-waits (centering the neck in setup()) finish. A delay() on
+// Core1 ends its turn until the delay is over rather than holding up Core0;
+// a sleep (WFI) moves the clock for both, as the other core is idle then.
+// simVisitors() schedules the same visitors for a given seed every run, so
+// tools that use it (the replay round trip, bench-dispatch) are repeatable.
+#ifndef CROW_SIM_H
+#define CROW_SIM_H
+
+#include "crow-host.h"
+#include "animatronic-crow.cpp"
+
+#define SIM_LOOP_US           100   // one turn of loop() and loop1()
+
+static uint64_t simCore1DueUs = 0;
+static uint32_t simVisitorState = 1;
+
+// called before (begin) and after the loop that runs the crow (runCrow())
+inline void (*simCrowProbe)(bool begin) = nullptr;
+
+inline void simCore1Delay(unsigned long ms) {
+  simCore1DueUs = hostMicros + (uint64_t)ms * 1000;
+}
+
+// boots the crow: setup() and setup1(), as after power-up
+inline void simBoot(int seedNoise) {
+  hostReset();
+  hostReadCostUs = 1;
+  hostAnalog[A0] = seedNoise;
+  setup();
+  setup1();
+}
+
+inline uint32_t simVisitorRandom(uint32_t lo, uint32_t hi) {
+  simVisitorState ^= simVisitorState << 13;
+  simVisitorState ^= simVisitorState >> 17;
+  simVisitorState ^= simVisitorState << 5;
+  return lo + simVisitorState % (hi - lo);
+}
+
+// visitors pass every 5-90s until untilUs and hold the sensor for 1-8s (a
+// 200ms press in SENSOR_MODE_BUTTON)
+inline void simVisitors(uint32_t seed, uint64_t untilUs) {
+  simVisitorState = seed ? seed : 1;
+  for (uint64_t at = hostMicros + simVisitorRandom(5000, 90000) * 1000ULL; at < untilUs;
+       at += simVisitorRandom(5000, 90000) * 1000ULL) {
+    uint64_t hold = simVisitorRandom(1000, 8000) * 1000ULL;
+    if (SENSOR_MODE == SENSOR_MODE_BUTTON) {
+      hostAt(at, []() { hostSetPin(PIN_MOTION_SENSOR, !buttonDefaultState); });
+      hostAt(at + 200000, []() { hostSetPin(PIN_MOTION_SENSOR, buttonDefaultState); });
+    } else {
+      hostAt(at, []() { hostSetPin(PIN_MOTION_SENSOR, HIGH); });
+      hostAt(at + hold, []() { hostSetPin(PIN_MOTION_SENSOR, LOW); });
+    }
+    at += hold;
+  }
+}
+
+inline void simLoop(void (*core)(), bool crow) {
+  if (crow && simCrowProbe) simCrowProbe(true);
+  core();
+  if (crow && simCrowProbe) simCrowProbe(false);
+}
+
+// runs both cores' loops until the clock reaches untilUs
+inline void simRun(uint64_t untilUs) {
+  while (hostMicros < untilUs) {
+    uint64_t start = hostMicros;
+    simLoop(loop, !CORE_SPLIT);
+    if (hostMicros >= simCore1DueUs) {
+      hostDelayHook = simCore1Delay;
+      simLoop(loop1, CORE_SPLIT);
+      hostDelayHook = nullptr;
+    }
+    uint64_t spent = hostMicros - start;
+    hostAdvance(spent < SIM_LOOP_US ? SIM_LOOP_US - spent : 0);
+  }
+}
+
+#endif
@@ -0,0 +1,44 @@
+// ============================================================================
+// FIT SERVO LAG
+// ============================================================================
+// Refits the beak lag model to curves saved from calibrate-crow `l`, e.g. to
+// compare servos or try a different LAG_ARRIVAL_PCT without the crow:
+//
+//   fit-servo-lag curves.txt    prints each move's lag and the fitted model
+//                               (exit 1 if it cannot be fitted)
+#include "crow-host.h"
+#include <Servo.h>
+#include "settings.h"
+#include "animations.h"
+#include "servo-lag.h"
+#include "servo-lag-csv.h"
+
+Servo beakServo;
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: fit-servo-lag curves.txt\n");
+    return 2;
+  }
+  FILE* f = fopen(argv[1], "r");
+  if (!f) {
+    fprintf(stderr, "fit-servo-lag: cannot open %s\n", argv[1]);
+    return 2;
+  }
+  LagCsvFit fit;
+  lagCsvRead(f, fit);
+  fclose(f);
+
+  for (const LagCsvMove& m : fit.moves) {
+    printf("travel %3u%%: ", m.travel);
+    if (m.lag < 0) printf("no arrival\n");
+    else printf("%dms\n", m.lag);
+  }
+  if (!fit.fitted) {
+    printf("Lag: cannot fit %zu moves (need two travels that arrived)\n", fit.moves.size());
+    return 1;
+  }
+  printf("Lag: beak leads by %ums + %ums per full move (calibrate-crow: l %u %u)\n", fit.baseMs, fit.travelMs,
+         fit.baseMs, fit.travelMs);
+  return 0;
+}
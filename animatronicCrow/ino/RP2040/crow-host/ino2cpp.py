@@ -0,0 +1,40 @@
+#!/usr/bin/env python3
+"""Turns a sketch's .ino into C++ the way the Arduino builder does: a
+prototype for every top-level function goes in front of the first function
+definition, so the host tools can compile the sketch itself.
+
+usage: ino2cpp.py sketch.ino out.cpp
+"""
+import re
+import sys
+
+# a top-level definition on one line: "type name(args) {"
+DEFINITION = re.compile(r'^([A-Za-z_][\w<>:*& ]*?[\s*&]+)([A-Za-z_]\w*)\s*\(([^;]*)\)\s*\{')
+KEYWORDS = ('if', 'for', 'while', 'switch', 'else', 'return', 'do')
+
+
+def prototype(match):
+    # default arguments belong on the prototype only
+    args = re.sub(r'\s*=\s*[^,)]+', '', match.group(3))
+    return '%s%s(%s);' % (match.group(1), match.group(2), args)
+
+
+def main():
+    src, out = sys.argv[1], sys.argv[2]
+    lines = open(src).read().split('\n')
+    definitions = [(i, m) for i, m in ((i, DEFINITION.match(l)) for i, l in enumerate(lines))
+                   if m and m.group(1).split()[0] not in KEYWORDS]
+    if not definitions:
+        sys.exit('%s: no function definitions' % src)
+    first = definitions[0][0]
+    protos = [prototype(m) for _, m in definitions]
+    with open(out, 'w') as f:
+        f.write('#line 1 "%s"\n' % src)
+        f.write('\n'.join(lines[:first]) + '\n')
+        f.write('\n'.join(protos) + '\n')
+        f.write('#line %d "%s"\n' % (first + 1, src))
+        f.write('\n'.join(lines[first:]))
+
+
+if __name__ == '__main__':
+    main()
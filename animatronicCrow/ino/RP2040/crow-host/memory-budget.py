@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Checks a linked crow firmware against the MEMORY_* budgets in its
+settings.h and breaks its flash and static RAM down by subsystem. Run after
+the build (see BUILD.md for the platform.local.txt hook that does it on every
+build); exits 1 when a budget is exceeded, so the build fails.
+
+Totals come from the RP2040 linker's section symbols (flash binary start/end,
+data start to bss end), or from `size` for an ELF without them. Subsystems
+are the sizes of their objects as `nm` lists them. String literals have no
+symbol, and the linker merges their .rodata.str sections into .rodata, so
+they are found by content instead: runs of text ending in a NUL in .rodata
+that no named object covers (an estimate: a table of text-like bytes can be
+counted too). What is left over is code and libraries. A sketch whose
+settings.h has no MEMORY_* budgets is skipped.
+
+usage: memory-budget.py [--tools PREFIX] firmware.elf settings.h
+       PREFIX: the toolchain's, e.g. arm-none-eabi- (the default)
+"""
+import re
+import subprocess
+import sys
+
+BUDGETS = ('MEMORY_FLASH_BUDGET_KB', 'MEMORY_RAM_BUDGET_KB', 'MEMORY_ANIM_BUDGET_BYTES')
+KEYFRAME_BYTES = 4          # sizeof(AnimKeyFrame) on the RP2040 (see memory.h)
+NUM_ANIMATIONS_MAX = 255    # tracks are numbered with a uint8_t
+TEXT = re.compile(rb'[\t\n\r\x20-\x7e\x80-\xf4]{2,}\x00')  # a string literal (UTF-8 allowed)
+
+# (subsystem, symbol names); flash ones match read-only and initialized data
+# (a table of pointers is initialized data on a PIE host), RAM ones data and bss
+FLASH = (
+    ('animations', r'anim_\w+|soundAnimations'),
+    ('scripts', r'script(Scold|Squawk|IdleMove|TryMe)'),
+)
+RAM = (
+    ('easing table', r'easingLUT'),
+    ('recorder logs', r'record\w+'),
+    ('drivers', r'stepper|beakServo|dfPlayer|statusLED|flockSerial'),
+    ('health+mailbox', r'health\w+|motion\w+'),
+)
+
+
+def budgets(path):
+    found = {}
+    try:
+        for line in open(path):
+            m = re.match(r'\s*#define\s+(MEMORY_\w+)\s+(\d+)', line)
+            if m:
+                found[m.group(1)] = int(m.group(2))
+    except OSError:
+        pass
+    return found
+
+
+def symbols(tools, elf):
+    # "address size type name" for objects, "address type name" for linker symbols
+    out = subprocess.run([tools + 'nm', '-S', '-C', '--defined-only', elf],
+                         check=True, capture_output=True, text=True).stdout
+    sized, addresses = [], {}
+    for line in out.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4:
+            sized.append((fields[3], int(fields[1], 16), fields[2], int(fields[0], 16)))
+        elif len(fields) == 3:
+            addresses[fields[2]] = int(fields[0], 16)
+    return sized, addresses
+
+
+def totals(tools, elf, addresses):
+    linker = ('__flash_binary_start', '__flash_binary_end', '__data_start__', '__bss_end__')
+    if all(s in addresses for s in linker):
+        return (addresses['__flash_binary_end'] - addresses['__flash_binary_start'],
+                addresses['__bss_end__'] - addresses['__data_start__'])
+    out = subprocess.run([tools + 'size', '-B', elf], check=True, capture_output=True, text=True).stdout
+    text, data, bss = (int(v) for v in out.splitlines()[1].split()[:3])
+    return text + data, data + bss
+
+
+def strings(tools, elf, sized):
+    # "[Nr] name type address offset size ..." for each section
+    out = subprocess.run([tools + 'readelf', '-S', '-W', elf], check=True, capture_output=True, text=True).stdout
+    image = open(elf, 'rb').read()
+    total = 0
+    for m in re.finditer(r'\]\s+(\.rodata\S*)\s+PROGBITS\s+([0-9a-f]+)\s+([0-9a-f]+)\s+([0-9a-f]+)', out):
+        address, offset, size = (int(v, 16) for v in m.groups()[1:])
+        data = bytearray(image[offset:offset + size])
+        for _, length, _, at in sized:
+            if address <= at < address + size:
+                data[at - address:at - address + length] = bytes(min(length, address + size - at))
+        total += sum(len(s.group()) for s in TEXT.finditer(data))
+    return total
+
+
+def grouped(sized, groups, types):
+    sizes = {name: 0 for name, _ in groups}
+    for symbol, size, kind, _ in sized:
+        if kind not in types:
+            continue
+        for name, pattern in groups:
+            if re.fullmatch(pattern, symbol):
+                sizes[name] += size
+                break
+    return sizes
+
+
+def line(name, size):
+    print('[Memory]   %-15s %d bytes' % (name, size))
+
+
+def main():
+    args = sys.argv[1:]
+    tools = 'arm-none-eabi-'
+    if len(args) == 4 and args[0] == '--tools':
+        tools, args = args[1], args[2:]
+    if len(args) != 2:
+        sys.exit(__doc__.split('\n\n')[-1])
+    elf, settings = args
+
+    limits = budgets(settings)
+    if not all(b in limits for b in BUDGETS):
+        print('[Memory] No MEMORY_* budgets in %s, nothing to check' % settings)
+        return 0
+    sized, addresses = symbols(tools, elf)
+    flash, ram = totals(tools, elf, addresses)
+    rom = grouped(sized, FLASH, 'rRdD')
+    text = strings(tools, elf, sized)
+    static = grouped(sized, RAM, 'dDbB')
+    anim = rom['animations']
+
+    over = []
+    if flash > limits['MEMORY_FLASH_BUDGET_KB'] * 1024:
+        over.append('flash')
+    if ram > limits['MEMORY_RAM_BUDGET_KB'] * 1024:
+        over.append('static RAM')
+    if anim > limits['MEMORY_ANIM_BUDGET_BYTES']:
+        over.append('animations')
+    print('[Memory] %sflash %d/%dKB, static RAM %d/%dKB, animations %d/%d bytes' % (
+        '✗ Over budget (%s): ' % ', '.join(over) if over else '', flash // 1024, limits['MEMORY_FLASH_BUDGET_KB'],
+        ram // 1024, limits['MEMORY_RAM_BUDGET_KB'], anim, limits['MEMORY_ANIM_BUDGET_BYTES']))
+
+    print('[Memory] Flash:')
+    for name, _ in FLASH:
+        line(name, rom[name])
+    line('strings', text)
+    line('code+libraries', flash - sum(rom.values()) - text)
+    print('[Memory] Static RAM:')
+    for name, _ in RAM:
+        line(name, static[name])
+    line('core+libraries', ram - sum(static.values()))
+
+    # Size model at the current average animation length
+    frames = [size for symbol, size, kind, _ in sized if kind in 'rRdD' and symbol.startswith('anim_')]
+    index = anim - sum(frames)
+    if frames:
+        each_index = index // len(frames)
+        avg = round(sum(frames) / KEYFRAME_BYTES / len(frames))
+        each = each_index + avg * KEYFRAME_BYTES
+        room = max(limits['MEMORY_ANIM_BUDGET_BYTES'] - anim, 0) // each
+        room = min(room, NUM_ANIMATIONS_MAX - len(frames))
+        print('[Memory] Each more animation of %d keyframes costs %d bytes of flash (10 more: %d); room for %d more'
+              % (avg, each, 10 * each, room))
+    return 1 if over else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Assembles behavior scripts written as text into the byte arrays behavior.h
+runs, so a script can be drafted without the S_* macros. One instruction per
+line, named after its opcode in lower case, arguments separated by spaces;
+`name:` defines a label and jumps name it. A script starts with
+`script <array name>`; # starts a comment.
+
+    script scriptSquawkTwice
+      again:
+      play 8 14
+      wait_idle
+      chance 30 again   # squawk again 30% of the time
+      end
+
+Numbers become bytes; anything else (a setting such as
+NECK_RANGE_SCOLD_PERCENT) is left for the compiler. The opcodes, their sizes
+and the NECK_* speeds (slow, fast, either) are read from behavior.h, and each
+array is followed by SCRIPT_CHECK, so the sketch still checks what the
+assembler cannot.
+
+usage: script-asm.py behavior.h scripts.txt out.h
+"""
+import re
+import sys
+
+# arguments by opcode: u8, s8 (signed percent), u16, speed, label
+ARGS = {
+    'END': (),
+    'WAIT': ('u16',),
+    'WAIT_RANDOM': ('u16', 'u16'),
+    'WAIT_IDLE': (),
+    'PLAY': ('u8', 'u8'),
+    'NECK_SPEED': ('speed',),
+    'NECK': ('s8',),
+    'NECK_RANDOM': ('u8', 'u8'),
+    'NECK_TOWARD': ('u8',),
+    'EYES': ('u8',),
+    'IF_SENSOR': ('label',),
+    'CHANCE': ('u8', 'label'),
+    'JUMP': ('label',),
+    'LABEL': ('label',),
+}
+ARG_BYTES = {'u8': 1, 's8': 1, 'u16': 2, 'speed': 1, 'label': 1}
+LABEL_MAX = 255
+
+
+class AsmError(Exception):
+    pass
+
+
+def opcodes(path):
+    """provides {name: (opcode, size)} and {speed: value} from behavior.h"""
+    text = open(path).read()
+    enum = re.search(r'enum ScriptOp\b[^{]*\{(.*?)\};', text, re.S)
+    sizes = re.search(r'scriptOpSize\[OP_COUNT\]\s*=\s*\{([^}]*)\}', text)
+    if not enum or not sizes:
+        sys.exit('%s: no ScriptOp enum or scriptOpSize table' % path)
+    names = re.findall(r'^\s*OP_(\w+)', enum.group(1), re.M)
+    names = [n for n in names if n != 'COUNT']
+    sizes = [int(s) for s in sizes.group(1).split(',')]
+    if sorted(names) != sorted(ARGS) or len(sizes) != len(names):
+        sys.exit('%s: opcodes differ from the assembler\'s, update ARGS' % path)
+    ops = {}
+    for code, (name, size) in enumerate(zip(names, sizes)):
+        if size != 1 + sum(ARG_BYTES[a] for a in ARGS[name]):
+            sys.exit('%s: OP_%s is %d bytes, the assembler has other arguments' % (path, name, size))
+        ops[name] = (code, size)
+    speeds = {m.group(1).lower(): int(m.group(2))
+              for m in re.finditer(r'#define\s+NECK_(SLOW|FAST|EITHER)\s+(\d+)', text)}
+    return ops, speeds
+
+
+def number(arg, lo, hi):
+    value = int(arg, 0)
+    if not lo <= value <= hi:
+        raise AsmError('%s is outside %d..%d' % (arg, lo, hi))
+    return value
+
+
+def operand(kind, arg, speeds, labels):
+    """provides the C bytes for one argument"""
+    if kind == 'label':
+        if arg not in labels:
+            labels[arg] = len(labels) + 1
+            if labels[arg] > LABEL_MAX:
+                raise AsmError('more than %d labels' % LABEL_MAX)
+        return ['%d' % labels[arg]]
+    if kind == 'speed':
+        if arg not in speeds:
+            raise AsmError('speed is one of %s, not %s' % (', '.join(sorted(speeds)), arg))
+        return ['%d' % speeds[arg]]
+    numeric = re.fullmatch(r'-?(0x[0-9a-fA-F]+|\d+)', arg)
+    if kind == 'u16':
+        if numeric:
+            value = number(arg, 0, 0xFFFF)
+            return ['0x%02X' % (value & 0xFF), '0x%02X' % (value >> 8)]
+        return ['(uint8_t)(%s)' % arg, '(uint8_t)((%s) >> 8)' % arg]
+    if numeric:
+        value = number(arg, -128, 127) & 0xFF if kind == 's8' else number(arg, 0, 255)
+        return ['%d' % value]
+    return ['(uint8_t)(int8_t)(%s)' % arg if kind == 's8' else '(%s)' % arg]
+
+
+def assemble(lines, ops, speeds):
+    """provides [(array name, [(C bytes, source)])], one entry per script"""
+    scripts = []
+    for line_no, raw in lines:
+        text = raw.split('#', 1)[0].strip()
+        if not text:
+            continue
+        try:
+            words = text.split()
+            if words[0] == 'script':
+                if len(words) != 2 or not re.fullmatch(r'[A-Za-z_]\w*', words[1]):
+                    raise AsmError('expected: script <array name>')
+                scripts.append((words[1], [], {}, {}, line_no))
+                continue
+            if not scripts:
+                raise AsmError('instruction before the first script line')
+            name, code, labels, defined, _ = scripts[-1]
+            if len(words) == 1 and words[0].endswith(':'):
+                label = words[0][:-1]
+                if label in defined:
+                    raise AsmError('label %s already defined on line %d' % (label, defined[label]))
+                defined[label] = line_no
+                op, words = 'LABEL', [label]
+            else:
+                op, words = words[0].upper(), words[1:]
+                if op not in ops or op == 'LABEL':
+                    raise AsmError('unknown instruction %s' % op.lower())
+            kinds = ARGS[op]
+            if len(words) != len(kinds):
+                raise AsmError('%s takes %d argument(s)' % (op.lower(), len(kinds)))
+            out = ['OP_' + op]
+            for kind, arg in zip(kinds, words):
+                out += operand(kind, arg, speeds, labels)
+            code.append((out, text))
+        except (AsmError, ValueError) as e:
+            raise AsmError('line %d: %s' % (line_no, e))
+
+    result = []
+    for name, code, labels, defined, start in scripts:
+        missing = sorted(set(labels) - set(defined))
+        if missing:
+            raise AsmError('line %d: %s jumps to undefined label(s) %s' % (start, name, ', '.join(missing)))
+        if not code or code[-1][0] != ['OP_END']:
+            raise AsmError('line %d: %s does not finish with end' % (start, name))
+        result.append((name, code))
+    return result
+
+
+def write(path, source, scripts):
+    with open(path, 'w') as f:
+        f.write('// Generated by script-asm.py from %s\n' % source)
+        for name, code in scripts:
+            f.write('\nconstexpr uint8_t %s[] PROGMEM = {\n' % name)
+            for out, text in code:
+                f.write('  %-40s // %s\n' % (', '.join(out) + ',', text))
+            f.write('};\nSCRIPT_CHECK(%s);\n' % name)
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__.split('\n\n')[-1])
+    header, source, out = sys.argv[1:]
+    ops, speeds = opcodes(header)
+    try:
+        scripts = assemble(enumerate(open(source).read().split('\n'), 1), ops, speeds)
+    except AsmError as e:
+        sys.exit('%s: %s' % (source, e))
+    write(out, source, scripts)
+
+
+if __name__ == '__main__':
+    main()
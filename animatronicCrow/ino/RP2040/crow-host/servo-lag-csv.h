@@ -0,0 +1,63 @@
+// ============================================================================
+// SAVED SERVO LAG CURVES
+// ============================================================================
+// Reads the curves calibrate-crow `l` prints (saved from the Serial Monitor)
+// and fits the lag model to them with the sketch's own lagFromCurve() and
+// fitServoLag(). A "lagspan,<travel>,<adcFrom>,<adcTo>" line starts a move
+// and its "lag,<travel>,<ms>,<adc>" lines are the samples; anything else in
+// the log is skipped. Needs servo-lag.h included first.
+#ifndef SERVO_LAG_CSV_H
+#define SERVO_LAG_CSV_H
+
+#include <vector>
+
+#define LAG_CSV_MAX_MOVES     255   // fitServoLag() counts moves in a uint8_t
+
+struct LagCsvMove {
+  uint8_t travel;
+  int from;
+  int to;
+  std::vector<uint16_t> samples;
+  int lag;                          // -1: never arrived
+};
+
+struct LagCsvFit {
+  std::vector<LagCsvMove> moves;
+  bool fitted = false;
+  uint16_t baseMs = 0;
+  uint16_t travelMs = 0;
+};
+
+inline void lagCsvFit(LagCsvFit& fit) {
+  uint8_t travel[LAG_CSV_MAX_MOVES];
+  uint16_t lagMs[LAG_CSV_MAX_MOVES];
+  uint8_t n = 0;
+  for (LagCsvMove& m : fit.moves) {
+    m.lag = lagFromCurve(m.samples.data(), m.samples.size(), m.from, m.to);
+    if (m.lag < 0 || n == LAG_CSV_MAX_MOVES) continue;
+    travel[n] = m.travel;
+    lagMs[n] = m.lag;
+    n++;
+  }
+  fit.fitted = fitServoLag(travel, lagMs, n, fit.baseMs, fit.travelMs);
+}
+
+// reads every move in f and fits them; false if the model could not be fitted
+inline bool lagCsvRead(FILE* f, LagCsvFit& fit) {
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    unsigned travel, ms, adc;
+    int from, to;
+    if (sscanf(line, "lagspan,%u,%d,%d", &travel, &from, &to) == 3) {
+      fit.moves.push_back({(uint8_t)travel, from, to, {}, -1});
+    } else if (sscanf(line, "lag,%u,%u,%u", &travel, &ms, &adc) == 3 && !fit.moves.empty()) {
+      std::vector<uint16_t>& samples = fit.moves.back().samples;
+      if (ms >= samples.size()) samples.resize(ms + 1, samples.empty() ? fit.moves.back().from : samples.back());
+      samples[ms] = adc;
+    }
+  }
+  lagCsvFit(fit);
+  return fit.fitted;
+}
+
+#endif
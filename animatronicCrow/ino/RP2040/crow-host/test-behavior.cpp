@@ -0,0 +1,134 @@
+// ============================================================================
+// BEHAVIOR SCRIPT TESTS
+// ============================================================================
+// scriptCheck() must reject the scripts the interpreter would run wrongly
+// (scripts.h only asserts it accepts the good ones), labelled jumps must
+// land where scriptCheck() assumed, and script-asm.py must assemble text
+// scripts (test-scripts.txt) into the bytes the S_* macros make.
+#include "crow-host.h"
+#include "settings.h"
+#include "behavior.h"
+#include "scripts.h"
+#include "test-scripts.h"
+
+static int plays = 0;
+static int eyes = -1;
+static bool sensor = false;
+
+bool scriptIdle() { return true; }
+bool scriptSensor() { return sensor; }
+void scriptPlay(uint8_t) { plays++; }
+void scriptNeckSpeed(bool) {}
+void scriptNeck(int) {}
+void scriptNeckToward(uint8_t) {}
+void scriptEyes(bool on) { eyes = on; }
+
+#define CHECK_SCRIPT(ok, ...) \
+  do { \
+    static const uint8_t code[] = {__VA_ARGS__}; \
+    CHECK(scriptCheck(code, sizeof(code)) == (ok)); \
+  } while (0)
+
+static void testCheck() {
+  CHECK(scriptCheck(scriptScold, sizeof(scriptScold)));
+  CHECK(scriptCheck(scriptTryMe, sizeof(scriptTryMe)));
+
+  // labels: defined, missing, defined twice
+  CHECK_SCRIPT(true, S_LABEL(1), S_WAIT(100), S_CHANCE(50, 1), S_END);
+  CHECK_SCRIPT(false, S_LABEL(1), S_WAIT(100), S_CHANCE(50, 2), S_END);
+  CHECK_SCRIPT(false, S_LABEL(1), S_WAIT(100), S_LABEL(1), S_JUMP(1), S_END);
+  CHECK_SCRIPT(false, S_IF_SENSOR(3), S_END);
+  CHECK_SCRIPT(true, S_IF_SENSOR(3), S_PLAY(1, 7), S_LABEL(3), S_END);
+
+  // not ending with S_END, a cut-off instruction, an unknown opcode
+  CHECK_SCRIPT(false, S_PLAY(1, 7), S_WAIT_IDLE);
+  CHECK_SCRIPT(false, S_END, OP_WAIT, 10);
+  CHECK_SCRIPT(false, OP_COUNT, S_END);
+  CHECK_SCRIPT(false, S_END, S_PLAY(1, 7));
+
+  // a loop has to wait (S_WAIT_IDLE does not, when the crow is idle)
+  CHECK_SCRIPT(false, S_LABEL(1), S_EYES(1), S_JUMP(1), S_END);
+  CHECK_SCRIPT(false, S_LABEL(1), S_WAIT_IDLE, S_JUMP(1), S_END);
+  CHECK_SCRIPT(false, S_LABEL(1), S_WAIT(50), S_LABEL(2), S_IF_SENSOR(2), S_JUMP(1), S_END);
+  CHECK_SCRIPT(true, S_LABEL(1), S_WAIT_RANDOM(50, 100), S_JUMP(1), S_END);
+
+  // SCRIPT_MAX_STEPS instructions up to a wait fit in one pass; one more
+  // does not
+  CHECK_SCRIPT(true, S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1),
+               S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_END);
+  CHECK_SCRIPT(false, S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1),
+               S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_END);
+}
+
+static void testJumps() {
+  hostReset();
+  hostAdvance(1000000);
+
+  // plays every 100ms until the sensor goes high, then closes the eyes
+  static constexpr uint8_t repeat[] = {
+    S_EYES(1),
+    S_LABEL(7),
+    S_PLAY(8, 14),
+    S_WAIT(100),
+    S_IF_SENSOR(2),
+    S_JUMP(7),
+    S_LABEL(2),
+    S_EYES(0),
+    S_END
+  };
+  SCRIPT_CHECK(repeat);
+  plays = 0;
+  sensor = false;
+  scriptStart(repeat);
+  CHECK_EQ(plays, 1);
+  CHECK_EQ(eyes, 1);
+  for (int i = 0; i < 3; i++) {
+    hostAdvance(100000);
+    CHECK(scriptUpdate(millis()));
+  }
+  CHECK_EQ(plays, 4);
+  sensor = true;
+  hostAdvance(100000);
+  CHECK(!scriptUpdate(millis()));
+  CHECK_EQ(plays, 4);
+  CHECK_EQ(eyes, 0);
+  CHECK(!scriptRunning());
+
+  // S_CHANCE at 100% always jumps, at 0% never
+  static const uint8_t always[] = {S_CHANCE(100, 1), S_PLAY(1, 7), S_LABEL(1), S_END};
+  static const uint8_t never[] = {S_CHANCE(0, 1), S_PLAY(1, 7), S_LABEL(1), S_END};
+  plays = 0;
+  for (int i = 0; i < 20; i++) scriptStart(always);
+  CHECK_EQ(plays, 0);
+  for (int i = 0; i < 20; i++) scriptStart(never);
+  CHECK_EQ(plays, 20);
+
+  // the longest burst scriptCheck() allows finishes in one pass
+  static const uint8_t burst[] = {S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1),
+                                  S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1), S_EYES(1),
+                                  S_EYES(1), S_END};
+  scriptStart(burst);
+  CHECK(!scriptRunning());
+}
+
+#define CHECK_SAME(a, b) CHECK(sizeof(a) == sizeof(b) && memcmp(a, b, sizeof(a)) == 0)
+
+static void testAssembler() {
+  CHECK_SAME(asmScold, scriptScold);
+  CHECK_SAME(asmIdleMove, scriptIdleMove);
+  CHECK_SAME(asmTryMe, scriptTryMe);
+
+  // labels are numbered in the order they are first named
+  static const uint8_t repeat[] = {
+    S_EYES(1), S_LABEL(1), S_PLAY(8, 14), S_WAIT(100), S_IF_SENSOR(2), S_JUMP(1), S_LABEL(2), S_NECK(-25),
+    S_EYES(0), S_END
+  };
+  CHECK_SAME(asmRepeat, repeat);
+}
+
+int main() {
+  testCheck();
+  testJumps();
+  testAssembler();
+  return hostReport("test-behavior");
+}
@@ -0,0 +1,172 @@
+// ============================================================================
+// STORED CALIBRATION TESTS
+// ============================================================================
+// Writes records into the stand-in EEPROM (hostEeprom) and checks what
+// loadCalibration() makes of them: round trips, a v1 record from before the
+// lag model, damaged records, and the optional-field flags.
+#include "crow-host.h"
+#include "settings.h"
+#include "animations.h"
+#include "calibration.h"
+
+static const CalibrationPayload defaults = crowCal;
+
+static void reset() {
+  memset(hostEeprom, 0xFF, sizeof(hostEeprom));
+  crowCal = defaults;
+  setServoLag(SERVO_LAG_BASE_MS, SERVO_LAG_TRAVEL_MS);
+  memset(easingLUT, 0, sizeof(easingLUT));
+}
+
+// a payload as calibrate-crow would write it
+static CalibrationPayload calibrated() {
+  CalibrationPayload p = defaults;
+  p.pwmOpen = 1050;
+  p.pwmClosed = 1420;
+  p.easingFactor = 2.5f;
+  p.fields = CAL_HAS_VOLUME | CAL_HAS_SYNC_DELAY | CAL_HAS_NECK_FAST | CAL_HAS_SERVO_LAG;
+  p.volume = 21;
+  p.audioSyncDelayMs = 180;
+  p.neckSlowMax = 2000;
+  p.neckSlowAccel = 300;
+  p.neckFastMax = 5000;
+  p.neckFastAccel = 3500;
+  hydrateEasingLUT(p.pwmOpen, p.pwmClosed, p.easingFactor);
+  memcpy(p.easingLUT, easingLUT, sizeof(easingLUT));
+  p.lagBaseMs = 30;
+  p.lagTravelMs = 45;
+  return p;
+}
+
+// stores length bytes of payload under a header of the given version
+static void store(const CalibrationPayload& payload, uint16_t version, uint16_t length) {
+  CalibrationHeader header = {CALIBRATION_MAGIC, version, length, calibrationCrc32((const uint8_t*)&payload, length)};
+  memcpy(hostEeprom, &header, sizeof(header));
+  memcpy(hostEeprom + sizeof(header), &payload, length);
+}
+
+static void testEmpty() {
+  reset();
+  CHECK_EQ(loadCalibration(), CAL_EMPTY);
+  CHECK_EQ(crowCal.pwmOpen, SERVO_PWM_OPEN);
+}
+
+static void testRoundTrip() {
+  reset();
+  crowCal = calibrated();
+  memcpy(easingLUT, crowCal.easingLUT, sizeof(easingLUT));
+  unsigned long commits = hostEepromCommits;
+  CHECK(saveCalibration());
+  CHECK_EQ(hostEepromCommits, commits + 1);
+
+  crowCal = defaults;
+  memset(easingLUT, 0, sizeof(easingLUT));
+  CHECK_EQ(loadCalibration(), CAL_LOADED);
+  CalibrationPayload want = calibrated();
+  CHECK_EQ(crowCal.pwmOpen, want.pwmOpen);
+  CHECK_EQ(crowCal.pwmClosed, want.pwmClosed);
+  CHECK_NEAR(crowCal.easingFactor, want.easingFactor, 0);
+  CHECK_EQ(crowCal.volume, want.volume);
+  CHECK_EQ(crowCal.audioSyncDelayMs, want.audioSyncDelayMs);
+  CHECK_EQ(crowCal.neckFastMax, want.neckFastMax);
+  CHECK_EQ(crowCal.neckFastAccel, want.neckFastAccel);
+  CHECK_EQ(crowCal.lagBaseMs, want.lagBaseMs);
+  CHECK_EQ(servoLagMs(100), want.lagBaseMs + want.lagTravelMs);
+  CHECK(memcmp(easingLUT, want.easingLUT, sizeof(easingLUT)) == 0);
+
+  // the slow neck is only taken when calibrate-crow set it
+  CHECK_EQ(crowCal.neckSlowMax, NECK_SPEED_SLOW_MAX);
+  CHECK_EQ(crowCal.neckSlowAccel, NECK_SPEED_SLOW_ACCEL);
+
+  reset();
+  crowCal = calibrated();
+  crowCal.fields |= CAL_HAS_NECK_SLOW;
+  memcpy(easingLUT, crowCal.easingLUT, sizeof(easingLUT));
+  CHECK(saveCalibration());
+  crowCal = defaults;
+  CHECK_EQ(loadCalibration(), CAL_LOADED);
+  CHECK_EQ(crowCal.neckSlowMax, 2000);
+  CHECK_EQ(crowCal.neckSlowAccel, 300);
+
+  CHECK(clearCalibration());
+  crowCal = defaults;
+  CHECK_EQ(loadCalibration(), CAL_EMPTY);
+}
+
+static void testMigrationV1() {
+  // v1 ended at the easing table: the lag model keeps its settings.h values
+  reset();
+  CalibrationPayload v1 = calibrated();
+  v1.fields &= ~CAL_HAS_SERVO_LAG;
+  store(v1, 1, offsetof(CalibrationPayload, lagBaseMs));
+
+  CHECK_EQ(loadCalibration(), CAL_LOADED);
+  CHECK_EQ(crowCal.pwmOpen, v1.pwmOpen);
+  CHECK_EQ(crowCal.volume, v1.volume);
+  CHECK_EQ(crowCal.neckFastMax, v1.neckFastMax);
+  CHECK_EQ(crowCal.lagBaseMs, SERVO_LAG_BASE_MS);
+  CHECK_EQ(crowCal.lagTravelMs, SERVO_LAG_TRAVEL_MS);
+  CHECK_EQ(servoLagMs(100), SERVO_LAG_BASE_MS + SERVO_LAG_TRAVEL_MS);
+  // v1 always stored the slow neck but never set it: it stays at settings.h
+  CHECK_EQ(crowCal.neckSlowMax, NECK_SPEED_SLOW_MAX);
+
+  // a v1 record cut inside the table loads the limits and rebuilds the table
+  reset();
+  store(v1, 1, offsetof(CalibrationPayload, easingLUT) + 20);
+  CHECK_EQ(loadCalibration(), CAL_REBUILT);
+  CHECK_EQ(easingLUT[0], v1.pwmClosed);
+  CHECK_EQ(easingLUT[100], v1.pwmOpen);
+
+  // a table that does not match the limits is rebuilt too
+  reset();
+  CalibrationPayload stale = calibrated();
+  stale.easingLUT[100] = 999;
+  store(stale, CALIBRATION_VERSION, sizeof(stale));
+  CHECK_EQ(loadCalibration(), CAL_REBUILT);
+  CHECK_EQ(easingLUT[100], stale.pwmOpen);
+}
+
+static void testBadRecords() {
+  CalibrationPayload good = calibrated();
+
+  // bad CRC: one flipped payload bit
+  reset();
+  store(good, CALIBRATION_VERSION, sizeof(good));
+  hostEeprom[sizeof(CalibrationHeader) + 3] ^= 0x10;
+  CHECK_EQ(loadCalibration(), CAL_CORRUPT);
+  CHECK_EQ(crowCal.pwmOpen, SERVO_PWM_OPEN);
+  CHECK_EQ(crowCal.fields, 0);
+
+  // bad CRC in the header itself
+  reset();
+  store(good, CALIBRATION_VERSION, sizeof(good));
+  hostEeprom[offsetof(CalibrationHeader, crc)] ^= 0x01;
+  CHECK_EQ(loadCalibration(), CAL_CORRUPT);
+
+  // bad length: zero, and longer than this version's payload
+  reset();
+  store(good, CALIBRATION_VERSION, 0);
+  CHECK_EQ(loadCalibration(), CAL_CORRUPT);
+  reset();
+  store(good, CALIBRATION_VERSION, sizeof(good));
+  CalibrationHeader header;
+  memcpy(&header, hostEeprom, sizeof(header));
+  header.length = sizeof(CalibrationPayload) + 2;
+  memcpy(hostEeprom, &header, sizeof(header));
+  CHECK_EQ(loadCalibration(), CAL_CORRUPT);
+  CHECK_EQ(crowCal.pwmOpen, SERVO_PWM_OPEN);
+
+  // a record from a newer calibrate-crow is left alone
+  reset();
+  store(good, CALIBRATION_VERSION + 1, sizeof(good));
+  CHECK_EQ(loadCalibration(), CAL_UNSUPPORTED);
+  CHECK_EQ(crowCal.pwmOpen, SERVO_PWM_OPEN);
+}
+
+int main() {
+  testEmpty();
+  testRoundTrip();
+  testMigrationV1();
+  testBadRecords();
+  return hostReport("test-calibration");
+}
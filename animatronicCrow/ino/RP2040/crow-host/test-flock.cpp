@@ -0,0 +1,377 @@
+// ============================================================================
+// FLOCK BUS SIMULATION
+// ============================================================================
+// Runs FLOCK_NODE_COUNT nodes of flock.h on one simulated half-duplex bus.
+// Each node receives through a real pipe; everything written during one
+// millisecond tick is delivered to the other nodes at the end of the tick.
+// Two writers in the same tick collide (their bytes are ORed together, as
+// two drivers fighting on the line), and a test can corrupt a node's next
+// frame, inject stray bytes, or keep one frame from reaching one node.
+#include "crow-host.h"
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "settings.h"
+#include "flock.h"
+
+struct FlockBus;
+
+// One node's UART: reads come from its pipe, writes go on the bus
+class PipeStream : public Stream {
+public:
+  FlockBus* bus = nullptr;
+  uint8_t node = 0;
+  int rx[2] = {-1, -1};
+
+  size_t write(uint8_t b) override;
+  int available() override {
+    int n = 0;
+    ioctl(rx[0], FIONREAD, &n);
+    return n;
+  }
+  int read() override {
+    uint8_t b;
+    return ::read(rx[0], &b, 1) == 1 ? b : -1;
+  }
+};
+
+struct FlockBus {
+  PipeStream ports[FLOCK_NODE_COUNT];
+  std::vector<uint8_t> tick[FLOCK_NODE_COUNT]; // bytes written this tick
+  int corruptNode = -1;                        // flip a CRC bit in its next frame
+  std::vector<uint8_t> noise;                  // stray bytes for this tick
+  int jamNode = -1;                            // another talker hits its next frame
+  std::vector<uint8_t> jam;
+  int deafNode = -1;                           // misses the next frame of deafType
+  uint8_t deafType = 0;
+  unsigned long frames = 0;                    // frames put on the wire
+  unsigned long collisions = 0;
+
+  FlockBus() {
+    for (uint8_t i = 0; i < FLOCK_NODE_COUNT; i++) {
+      ports[i].bus = this;
+      ports[i].node = i;
+      if (pipe2(ports[i].rx, O_NONBLOCK) != 0) abort();
+    }
+  }
+  ~FlockBus() {
+    for (PipeStream& p : ports) {
+      close(p.rx[0]);
+      close(p.rx[1]);
+    }
+  }
+
+  // end of tick: put the line state in every listener's pipe
+  void deliver() {
+    if (jamNode >= 0 && !tick[jamNode].empty()) {
+      noise = jam;
+      jamNode = -1;
+    }
+    std::vector<uint8_t> line = noise;
+    int writers = noise.empty() ? 0 : 1;
+    int sender = -1;
+    for (uint8_t i = 0; i < FLOCK_NODE_COUNT; i++) {
+      if (tick[i].empty()) continue;
+      writers++;
+      sender = i;
+      frames += tick[i].size() / FLOCK_FRAME_LEN;
+      if (corruptNode == i) {
+        tick[i][FLOCK_FRAME_LEN - 1] ^= 0x01;
+        corruptNode = -1;
+      }
+      if (line.size() < tick[i].size()) line.resize(tick[i].size(), 0);
+      for (size_t b = 0; b < tick[i].size(); b++) line[b] |= tick[i][b];
+    }
+    if (writers > 1) collisions++;
+    for (uint8_t i = 0; i < FLOCK_NODE_COUNT; i++) {
+      // a lone sender's receiver is off while it drives the line
+      if (!line.empty() && !(writers == 1 && sender == i)) {
+        std::vector<uint8_t> heard = i == deafNode ? missFrame(line) : line;
+        if (::write(ports[i].rx[1], heard.data(), heard.size()) != (ssize_t)heard.size()) abort();
+      }
+      tick[i].clear();
+    }
+    noise.clear();
+  }
+
+  // the line without its first deafType frame (and deafNode hears the rest)
+  std::vector<uint8_t> missFrame(const std::vector<uint8_t>& line) {
+    std::vector<uint8_t> heard = line;
+    for (size_t at = 0; at + FLOCK_FRAME_LEN <= heard.size(); at += FLOCK_FRAME_LEN) {
+      if (heard[at] != FLOCK_SYNC_BYTE || heard[at + 2] != deafType) continue;
+      heard.erase(heard.begin() + at, heard.begin() + at + FLOCK_FRAME_LEN);
+      deafNode = -1;
+      break;
+    }
+    return heard;
+  }
+};
+
+size_t PipeStream::write(uint8_t b) {
+  bus->tick[node].push_back(b);
+  return 1;
+}
+
+struct Sim {
+  FlockBus bus;
+  FlockNode nodes[FLOCK_NODE_COUNT];
+  bool running[FLOCK_NODE_COUNT];
+  uint8_t action[FLOCK_NODE_COUNT];             // last action returned
+  unsigned long actions[FLOCK_NODE_COUNT];      // actions returned
+  unsigned long actionTime[FLOCK_NODE_COUNT];   // when it was returned
+  unsigned long sensorFrames[FLOCK_NODE_COUNT]; // SENSOR frames each node sent
+
+  Sim() {
+    hostReset();
+    hostAdvance(1000000); // start well past zero
+    for (uint8_t i = 0; i < FLOCK_NODE_COUNT; i++) {
+      flockBegin(nodes[i], i, bus.ports[i]);
+      running[i] = true;
+      action[i] = FLOCK_ACTION_NONE;
+      actionTime[i] = 0;
+      actions[i] = 0;
+      sensorFrames[i] = 0;
+    }
+  }
+
+  void clearActions() {
+    for (uint8_t i = 0; i < FLOCK_NODE_COUNT; i++) action[i] = FLOCK_ACTION_NONE;
+  }
+
+  // one millisecond of every running node's loop
+  void tick(const bool* sensor = nullptr) {
+    hostAdvance(1000);
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < FLOCK_NODE_COUNT; i++) {
+      if (!running[i]) continue;
+      flockSensor(nodes[i], sensor != nullptr && sensor[i] && flockOnline(nodes[i], now), now);
+      unsigned long before = nodes[i].framesTx;
+      uint8_t a = flockUpdate(nodes[i], now);
+      if (i != 0 && nodes[i].framesTx != before) sensorFrames[i] += nodes[i].framesTx - before;
+      if (a != FLOCK_ACTION_NONE) {
+        action[i] = a;
+        actionTime[i] = now;
+        actions[i]++;
+      }
+    }
+    bus.deliver();
+  }
+
+  void run(unsigned long ms, const bool* sensor = nullptr) {
+    while (ms--) tick(sensor);
+  }
+
+  // holds one node's sensor high for ms
+  void sense(uint8_t node, unsigned long ms) {
+    bool sensor[FLOCK_NODE_COUNT] = {};
+    sensor[node] = true;
+    run(ms, sensor);
+  }
+};
+
+static void testBeacons() {
+  Sim sim;
+  for (uint8_t i = 1; i < FLOCK_NODE_COUNT; i++) CHECK(!flockOnline(sim.nodes[i], millis()));
+  CHECK(flockOnline(sim.nodes[0], millis()));
+  sim.run(FLOCK_CYCLE_MS * 3);
+  for (uint8_t i = 1; i < FLOCK_NODE_COUNT; i++) {
+    CHECK(flockOnline(sim.nodes[i], millis()));
+    CHECK_EQ(sim.nodes[i].crcErrors, 0);
+    CHECK_EQ(sim.nodes[i].cycle + 1, sim.nodes[0].cycle);
+  }
+  CHECK_EQ(sim.bus.collisions, 0);
+}
+
+static void testWave() {
+  Sim sim;
+  sim.run(FLOCK_CYCLE_MS * 2);
+  unsigned long start = millis();
+  sim.sense(2, 5);
+  sim.run(FLOCK_CYCLE_MS * 2 + 3 * FLOCK_WAVE_STEP_MS);
+
+  // origin 2 scolds first, then its neighbors turn toward it one step apart
+  CHECK_EQ(sim.action[2], FLOCK_ACTION_SCOLD);
+  CHECK_EQ(sim.action[1], FLOCK_ACTION_TURN_UP);
+  CHECK_EQ(sim.action[3], FLOCK_ACTION_TURN_DOWN);
+  CHECK_EQ(sim.action[0], FLOCK_ACTION_TURN_UP);
+  CHECK(sim.actionTime[2] - start <= 2 * FLOCK_CYCLE_MS + 2); // reported within a cycle, waved the next
+  CHECK_NEAR(sim.actionTime[1] - sim.actionTime[2], FLOCK_WAVE_STEP_MS, 1);
+  CHECK_NEAR(sim.actionTime[3] - sim.actionTime[2], FLOCK_WAVE_STEP_MS, 1);
+  CHECK_NEAR(sim.actionTime[0] - sim.actionTime[2], 2 * FLOCK_WAVE_STEP_MS, 1);
+  CHECK_EQ(sim.sensorFrames[2], 1);
+
+  // the leader's own sensor waves the other way
+  sim.clearActions();
+  sim.run(SCOLD_SQUAWK_BLOCK_MS);
+  sim.sense(0, 5);
+  sim.run(FLOCK_CYCLE_MS + 3 * FLOCK_WAVE_STEP_MS);
+  CHECK_EQ(sim.action[0], FLOCK_ACTION_SCOLD);
+  CHECK_EQ(sim.action[3], FLOCK_ACTION_TURN_DOWN);
+  CHECK_NEAR(sim.actionTime[3] - sim.actionTime[0], 3 * FLOCK_WAVE_STEP_MS, 1);
+}
+
+static void testHeldSensor() {
+  Sim sim;
+  sim.run(FLOCK_CYCLE_MS * 2);
+  sim.sense(1, 2000); // a visitor standing in front of crow 1
+  CHECK_EQ(sim.sensorFrames[1], 1);
+  CHECK_EQ(sim.action[1], FLOCK_ACTION_SCOLD);
+
+  // a new visitor after the block starts a new report
+  sim.clearActions();
+  sim.run(SCOLD_SQUAWK_BLOCK_MS);
+  sim.sense(1, 2000);
+  CHECK_EQ(sim.sensorFrames[1], 2);
+  CHECK_EQ(sim.action[1], FLOCK_ACTION_SCOLD);
+}
+
+static void testCorruptedCrc() {
+  Sim sim;
+  sim.run(FLOCK_CYCLE_MS * 2);
+
+  // the first SENSOR frame fails the leader's CRC check; the retry next cycle
+  // gets through
+  sim.bus.corruptNode = 3;
+  unsigned long start = millis();
+  sim.sense(3, 5);
+  sim.run(FLOCK_CYCLE_MS * 3);
+  CHECK_EQ(sim.nodes[0].crcErrors, 1);
+  CHECK_EQ(sim.sensorFrames[3], 2);
+  CHECK_EQ(sim.action[3], FLOCK_ACTION_SCOLD);
+  CHECK(sim.actionTime[3] - start <= 3 * FLOCK_CYCLE_MS + 2);
+
+  // a corrupted beacon does not take the WAVE behind it down too
+  sim.clearActions();
+  sim.run(SCOLD_SQUAWK_BLOCK_MS);
+  unsigned long followerErrors = sim.nodes[1].crcErrors;
+  sim.sense(2, 5);
+  while (sim.nodes[0].pendingOrigin < 0) sim.tick();
+  sim.bus.corruptNode = 0;
+  sim.run(FLOCK_CYCLE_MS);
+  CHECK_EQ(sim.nodes[1].crcErrors, followerErrors + 1);
+  CHECK_EQ(sim.action[2], FLOCK_ACTION_SCOLD);
+  sim.run(FLOCK_WAVE_STEP_MS);
+  CHECK_EQ(sim.action[1], FLOCK_ACTION_TURN_UP);
+
+  // all retries lost: the report gives up after FLOCK_SENSOR_SENDS frames
+  sim.clearActions();
+  sim.run(SCOLD_SQUAWK_BLOCK_MS);
+  sim.sensorFrames[1] = 0;
+  bool sensor[FLOCK_NODE_COUNT] = {false, true, false, false};
+  for (int ms = 0; ms < FLOCK_CYCLE_MS * (FLOCK_SENSOR_SENDS + 2); ms++) {
+    sim.bus.corruptNode = 1;
+    sim.tick(sensor);
+  }
+  CHECK_EQ(sim.sensorFrames[1], FLOCK_SENSOR_SENDS);
+  CHECK_EQ(sim.action[1], FLOCK_ACTION_NONE);
+}
+
+static void testLostWave() {
+  Sim sim;
+  sim.run(FLOCK_CYCLE_MS * 2);
+
+  // the origin misses the WAVE for its own report: its next SENSOR gets the
+  // same WAVE again, without restarting the block or turning the others twice
+  sim.bus.deafNode = 2;
+  sim.bus.deafType = FLOCK_MSG_WAVE;
+  sim.sense(2, 5);
+  while (sim.nodes[0].pendingOrigin < 0) sim.tick();
+  unsigned long waveTime = sim.nodes[0].lastWaveTime;
+  sim.run(FLOCK_CYCLE_MS * (FLOCK_SENSOR_SENDS + 1) + 3 * FLOCK_WAVE_STEP_MS);
+  CHECK_EQ(sim.bus.deafNode, -1);
+  CHECK_EQ(sim.sensorFrames[2], 2);
+  CHECK_EQ(sim.action[2], FLOCK_ACTION_SCOLD);
+  CHECK_EQ(sim.actions[2], 1);
+  CHECK_EQ(sim.nodes[0].lastWaveTime, waveTime);
+  for (uint8_t i = 0; i < FLOCK_NODE_COUNT; i++) {
+    if (i != 2) CHECK_EQ(sim.actions[i], 1);
+  }
+  CHECK_EQ(sim.nodes[0].sensorsBlocked, 0);
+
+  // motion at another crow within the block is dropped, and counted
+  sim.clearActions();
+  sim.sense(3, 5);
+  sim.run(FLOCK_CYCLE_MS * (FLOCK_SENSOR_SENDS + 1));
+  CHECK_EQ(sim.action[3], FLOCK_ACTION_NONE);
+  CHECK_EQ(sim.nodes[0].sensorsBlocked, FLOCK_SENSOR_SENDS);
+
+  // after the block the same origin starts a new wave
+  sim.run(SCOLD_SQUAWK_BLOCK_MS);
+  sim.sense(2, 5);
+  sim.run(FLOCK_CYCLE_MS * 2);
+  CHECK_EQ(sim.actions[2], 2);
+}
+
+static void testCollision() {
+  Sim sim;
+  sim.run(FLOCK_CYCLE_MS * 2);
+
+  // stray bytes (another talker, a floating line) land on top of the SENSOR
+  // frame: the leader drops the garbage, resyncs and hears the retry
+  unsigned long start = millis();
+  bool sensor[FLOCK_NODE_COUNT] = {false, false, true, false};
+  sim.bus.jamNode = 2;
+  sim.bus.jam = {0x55, 0x7E, 0x13, 0x00, 0xA1};
+  sim.run(FLOCK_CYCLE_MS * 3, sensor);
+  CHECK_EQ(sim.bus.collisions, 1);
+  CHECK(sim.nodes[0].crcErrors >= 1);
+  CHECK_EQ(sim.sensorFrames[2], 2);
+  CHECK_EQ(sim.action[2], FLOCK_ACTION_SCOLD);
+  CHECK(sim.actionTime[2] - start <= 3 * FLOCK_CYCLE_MS + 2);
+
+  // a frame cut short is followed at once by a whole one: the receiver
+  // finds the SYNC inside the bad frame and loses nothing after it
+  unsigned long received = sim.nodes[3].framesRx;
+  sim.bus.noise = {FLOCK_SYNC_BYTE, 0x01, 0x02};
+  sim.bus.deliver();
+  while (sim.nodes[3].framesRx == received) sim.tick();
+  CHECK_EQ(sim.nodes[3].framesRx, received + 1);
+  CHECK(flockOnline(sim.nodes[3], millis()));
+}
+
+static void testLeaderTimeout() {
+  Sim sim;
+  sim.run(FLOCK_CYCLE_MS * 2);
+  CHECK(flockOnline(sim.nodes[2], millis()));
+  sim.running[0] = false;
+  sim.run(FLOCK_LEADER_TIMEOUT_MS - FLOCK_CYCLE_MS * 2);
+  CHECK(flockOnline(sim.nodes[2], millis()));
+  sim.run(FLOCK_CYCLE_MS * 2);
+  CHECK(!flockOnline(sim.nodes[2], millis()));
+
+  // back to standalone: nothing is sent without a leader
+  sim.sense(2, FLOCK_CYCLE_MS * 2);
+  CHECK_EQ(sim.sensorFrames[2], 0);
+
+  // and back online with the next beacon
+  sim.running[0] = true;
+  sim.run(FLOCK_CYCLE_MS + 2);
+  CHECK(flockOnline(sim.nodes[2], millis()));
+}
+
+static void testBusLoad() {
+  // every follower triggered in the same cycle still fits N + 1 frames
+  Sim sim;
+  sim.run(FLOCK_CYCLE_MS * 2);
+  bool sensor[FLOCK_NODE_COUNT] = {true, true, true, true};
+  unsigned long worst = 0;
+  for (int cycle = 0; cycle < 20; cycle++) {
+    unsigned long before = sim.bus.frames;
+    sim.run(FLOCK_CYCLE_MS, sensor);
+    worst = max(worst, sim.bus.frames - before);
+  }
+  CHECK(worst <= FLOCK_NODE_COUNT + 1);
+  CHECK_EQ(sim.bus.collisions, 0);
+}
+
+int main() {
+  testBeacons();
+  testWave();
+  testHeldSensor();
+  testCorruptedCrc();
+  testLostWave();
+  testCollision();
+  testLeaderTimeout();
+  testBusLoad();
+  return hostReport("test-flock");
+}
@@ -0,0 +1,116 @@
+// ============================================================================
+// HEALTH MONITOR TESTS
+// ============================================================================
+// Runs the whole sketch (crow-sim.h) through the health monitor's recoveries:
+// a DFPlayer that stops answering and comes back, a reboot the sketch asks
+// for, and one the watchdog forces on its own. Faults are printed by the
+// crow's loop, not where they are recorded.
+#include "crow-sim.h"
+
+static uint64_t seconds(uint64_t s) {
+  return s * 1000000ULL;
+}
+
+static void testDFPlayer() {
+  simBoot(1);
+  CHECK(dfPlayerOnline);
+  uint16_t faults = healthRecord.faults[FAULT_DFPLAYER];
+
+  // a check goes out and the loop carries on while it waits for the reply
+  hostDfPlayerOnline = false;
+  uint64_t giveUp = hostMicros + (HEALTH_DFPLAYER_CHECK_MS + 60000) * 1000ULL;
+  while (dfPlayerCheck != DFPLAYER_CHECK_QUERY && hostMicros < giveUp) simRun(hostMicros + SIM_LOOP_US);
+  CHECK_EQ(dfPlayerCheck, DFPLAYER_CHECK_QUERY);
+  unsigned long sent = lastDFPlayerCheck;
+  simRun(hostMicros + seconds(1));
+  CHECK_EQ(dfPlayerCheck, DFPLAYER_CHECK_QUERY);
+  CHECK(dfPlayerOnline);
+  simRun(hostMicros + HEALTH_DFPLAYER_REPLY_MS * 1000ULL);
+  CHECK_EQ(healthRecord.faults[FAULT_DFPLAYER], faults + 1);
+  CHECK_EQ(healthRecord.lastFault, FAULT_DFPLAYER);
+  CHECK(!dfPlayerOnline);
+  CHECK_EQ(lastDFPlayerCheck, sent);
+
+  // restarts keep failing quietly while it stays silent
+  simRun(hostMicros + HEALTH_DFPLAYER_RETRY_MS * 3000ULL);
+  CHECK(!dfPlayerOnline);
+  CHECK_EQ(healthRecord.faults[FAULT_DFPLAYER], faults + 1);
+
+  // and the next one brings it back, at the calibrated volume
+  hostDfPlayerOnline = true;
+  dfPlayer.volumeLevel = 0;
+  simRun(hostMicros + (HEALTH_DFPLAYER_RETRY_MS + 60000) * 1000ULL);
+  CHECK(dfPlayerOnline);
+  CHECK_EQ(dfPlayer.volumeLevel, crowCal.volume);
+  CHECK_EQ(healthRecord.faults[FAULT_DFPLAYER], faults + 1);
+}
+
+static void testReboots() {
+  hostWatchdogCausedReboot = false;
+  simBoot(1);
+  uint16_t watchdog = healthRecord.faults[FAULT_WATCHDOG];
+  uint16_t reboots = healthRecord.faults[FAULT_REBOOT];
+
+  // asked for (the loop asks again until the watchdog fires): counted once
+  healthFault(FAULT_MODE_STUCK);
+  healthReboot();
+  healthReboot();
+  CHECK_EQ(healthRecord.faults[FAULT_REBOOT], reboots + 1);
+  CHECK_EQ(healthRecord.lastFault, FAULT_MODE_STUCK);
+
+  // ...and not counted again as the watchdog's when the board comes back
+  healthRebooting = false;
+  hostWatchdogCausedReboot = true;
+  digitalWrite(PIN_LED_EYES, HIGH);
+  simBoot(1);
+  CHECK(healthQuickStart);
+  CHECK_EQ(healthRecord.faults[FAULT_WATCHDOG], watchdog);
+  CHECK(!healthRecord.rebootAsked);
+  CHECK_EQ(digitalRead(PIN_LED_EYES), TEST_MODE ? HIGH : LOW);
+
+  // a watchdog reboot nobody asked for is the watchdog's
+  simBoot(1);
+  CHECK_EQ(healthRecord.faults[FAULT_WATCHDOG], watchdog + 1);
+  CHECK_EQ(healthRecord.faults[FAULT_REBOOT], reboots + 1);
+  hostWatchdogCausedReboot = false;
+}
+
+static size_t count(const std::string& text) {
+  size_t n = 0;
+  for (size_t at = Serial.out.find(text); at != std::string::npos; at = Serial.out.find(text, at + 1)) n++;
+  return n;
+}
+
+static void testLog() {
+  simBoot(1);
+  simRun(hostMicros + seconds(1));
+
+  // recorded as Core0 would (healthWatch()), printed once by the crow's loop
+  Serial.out.clear();
+  healthFault(FAULT_CORE1_STALL);
+  CHECK(Serial.out.empty());
+  simRun(hostMicros + seconds(1));
+  char line[64];
+  snprintf(line, sizeof(line), "[Health] ✗ Fault: Core1 stall (#%u)", healthRecord.faults[FAULT_CORE1_STALL]);
+  CHECK_EQ(count(line), 1);
+  CHECK_EQ(count("[Health] ✗ Fault:"), 1);
+
+  // and a reboot the same way, after the fault that caused it
+  Serial.out.clear();
+  healthFault(FAULT_MODE_STUCK);
+  healthReboot();
+  CHECK(Serial.out.empty());
+  simRun(hostMicros + seconds(1));
+  CHECK_EQ(count("[Health] ✗ Fault: stuck mode"), 1);
+  CHECK_EQ(count("[Health] ✗ Fault: reboot"), 1);
+  CHECK_EQ(count("[Health] Rebooting through the watchdog"), 1);
+  CHECK(Serial.out.find("stuck mode") < Serial.out.find("Rebooting"));
+  healthRebooting = false;
+}
+
+int main() {
+  testLog();
+  testDFPlayer();
+  testReboots();
+  return hostReport("test-health");
+}
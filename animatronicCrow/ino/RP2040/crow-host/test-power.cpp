@@ -0,0 +1,170 @@
+// ============================================================================
+// POWER MANAGER TESTS
+// ============================================================================
+// The idle deadline and sleep length are pure functions of the schedule; the
+// sleep itself runs against the stand-in alarm and WFI, so a sensor edge
+// scheduled on the simulated clock ends it like the real interrupt would.
+#include "crow-host.h"
+#include "settings.h"
+#include "power.h"
+
+AccelStepper stepper;
+
+static PowerSchedule quiet(unsigned long now) {
+  // nothing due for a minute, no recent audio or movement
+  PowerSchedule s = {now + 60000, now + 60000, now + 60000, now - 60000, now - 60000, false, true, false};
+  return s;
+}
+
+static void testIdleDeadline() {
+  unsigned long now = 100000;
+  PowerSchedule s = quiet(now);
+  CHECK_EQ(powerIdleDeadline(now, s), now + 60000);
+
+  // the earliest of blink, squawk and move
+  s.nextBlinkTime = now + 700;
+  CHECK_EQ(powerIdleDeadline(now, s), now + 700);
+  s.nextMoveTime = now + 300;
+  CHECK_EQ(powerIdleDeadline(now, s), now + 300);
+  s.nextSquawkTime = now + 50;
+  CHECK_EQ(powerIdleDeadline(now, s), now + 50);
+
+  // a squawk due during the squawk block waits for the block to end
+  s = quiet(now);
+  s.nextSquawkTime = now + 10;
+  s.lastAudioTime = now - 1000;
+  CHECK_EQ(powerIdleDeadline(now, s), now - 1000 + SCOLD_SQUAWK_BLOCK_MS);
+
+  // no blinking in TEST_MODE: wake at least every POWER_MAX_SLEEP_MS
+  s = quiet(now);
+  s.blinking = false;
+  s.nextBlinkTime = now + 5;
+  CHECK_EQ(powerIdleDeadline(now, s), now + POWER_MAX_SLEEP_MS);
+
+  // LD1020 holds both the move and the squawk until the cooldown ends
+  s = quiet(now);
+  s.ld1020 = true;
+  s.lastMovementTime = now - 500;
+  s.nextMoveTime = now + 100;
+  s.nextSquawkTime = now + 200;
+  CHECK_EQ(powerIdleDeadline(now, s), now - 500 + LD1020_ANIMATION_COOLDOWN_MS);
+  s.ld1020 = false;
+  CHECK_EQ(powerIdleDeadline(now, s), now + 100);
+
+  // a flock node wakes every slot to service the bus
+  s = quiet(now);
+  s.flock = true;
+  CHECK_EQ(powerIdleDeadline(now, s), now + FLOCK_SLOT_MS);
+
+  // an event already overdue is the deadline (the caller then does not sleep)
+  s = quiet(now);
+  s.nextMoveTime = now - 20;
+  CHECK_EQ(powerIdleDeadline(now, s), now - 20);
+  CHECK_EQ(powerSleepLength(now, now - 20, false), 0);
+}
+
+static void testSleepLength() {
+  unsigned long now = 5000;
+  CHECK_EQ(powerSleepLength(now, now + POWER_MIN_SLEEP_MS - 1, false), 0);
+  CHECK_EQ(powerSleepLength(now, now + POWER_MIN_SLEEP_MS, false), POWER_MIN_SLEEP_MS);
+  CHECK_EQ(powerSleepLength(now, now + 400, false), 400);
+  CHECK_EQ(powerSleepLength(now, now + POWER_MAX_SLEEP_MS * 5, false), POWER_MAX_SLEEP_MS);
+  CHECK_EQ(powerSleepLength(now, now - 10, false), 0);
+  CHECK_EQ(powerSleepLength(now, now + 400, true), 0);
+}
+
+static void testSleep() {
+  hostReset();
+  hostAdvance(10000000);
+  pinMode(PIN_MOTION_SENSOR, INPUT);
+  hostSetPin(PIN_MOTION_SENSOR, LOW);
+  powerBegin(true);
+
+  // sleeps to the deadline, capped at POWER_MAX_SLEEP_MS
+  unsigned long now = millis();
+  powerSleepUntil(now, now + 400);
+  CHECK_EQ(millis() - now, 400);
+  now = millis();
+  powerSleepUntil(now, now + 5000);
+  CHECK_EQ(millis() - now, POWER_MAX_SLEEP_MS);
+  CHECK_EQ(powerSleepCount, 2);
+  CHECK_EQ(powerSleepMs, 400 + POWER_MAX_SLEEP_MS);
+  CHECK(hostTimers.empty()); // the alarm was used up or cancelled
+
+  // a deadline inside POWER_MIN_SLEEP_MS does not sleep at all
+  now = millis();
+  powerSleepUntil(now, now + POWER_MIN_SLEEP_MS - 1);
+  CHECK_EQ(millis(), now);
+  CHECK_EQ(powerSleepCount, 2);
+
+  // a sensor edge ends the sleep early and the alarm is cancelled
+  now = millis();
+  hostAt(hostMicros + 120500, []() { hostSetPin(PIN_MOTION_SENSOR, HIGH); });
+  powerSleepUntil(now, now + 800);
+  CHECK_EQ(micros() - (now * 1000UL), 120500);
+  CHECK_EQ(powerSensorWakes, 1);
+  CHECK_EQ(powerWakeLatencyUs, 0);
+  CHECK(hostTimers.empty());
+
+  // held awake for POWER_SENSOR_HOLD_MS after a sensor wake
+  unsigned long woke = millis();
+  hostAdvance(10000);
+  powerSleepUntil(millis(), millis() + 800);
+  CHECK_EQ(millis(), woke + 10);
+  CHECK_EQ(powerSleepCount, 3);
+  hostAdvance((POWER_SENSOR_HOLD_MS - 11) * 1000UL);
+  powerSleepUntil(millis(), millis() + 800);
+  CHECK_EQ(powerSleepCount, 3);
+  hostAdvance(1000);
+  now = millis();
+  powerSleepUntil(now, now + 800);
+  CHECK_EQ(powerSleepCount, 4);
+  CHECK_EQ(millis() - now, 800);
+
+  // the falling edge wakes it too (the sensor pin interrupts on CHANGE)
+  now = millis();
+  hostAt(hostMicros + 30000, []() { hostSetPin(PIN_MOTION_SENSOR, LOW); });
+  powerSleepUntil(now, now + 800);
+  CHECK_EQ(millis() - now, 30);
+  CHECK_EQ(powerSensorWakes, 2);
+
+  // an edge while awake (after the last sensor poll) is not lost: the next
+  // sleep holds as if it had woken for it
+  hostAdvance(POWER_SENSOR_HOLD_MS * 1000UL);
+  hostSetPin(PIN_MOTION_SENSOR, HIGH);
+  hostAdvance(5000);
+  now = millis();
+  unsigned long sleeps = powerSleepCount;
+  powerSleepUntil(now, now + 800);
+  CHECK_EQ(millis(), now);
+  CHECK_EQ(powerSleepCount, sleeps);
+  hostAdvance(POWER_SENSOR_HOLD_MS * 1000UL);
+  now = millis();
+  powerSleepUntil(now, now + 800);
+  CHECK_EQ(millis() - now, 800);
+}
+
+static void testCoils() {
+  hostReset();
+  hostAdvance(1000000);
+  powerCoilsOn = true;
+  stepper.enableOutputs();
+  unsigned long now = millis();
+  powerUpdate(now, false);
+  powerUpdate(now + POWER_COIL_RELEASE_MS - 1, true);
+  CHECK(powerCoilsOn);
+  powerUpdate(now + POWER_COIL_RELEASE_MS, true);
+  CHECK(!powerCoilsOn);
+  CHECK(!stepper.outputsEnabled);
+  powerWakeNeck();
+  CHECK(powerCoilsOn);
+  CHECK(stepper.outputsEnabled);
+}
+
+int main() {
+  testIdleDeadline();
+  testSleepLength();
+  testSleep();
+  testCoils();
+  return hostReport("test-power");
+}
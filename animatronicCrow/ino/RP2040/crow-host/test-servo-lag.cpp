@@ -0,0 +1,155 @@
+// ============================================================================
+// SERVO LAG TESTS
+// ============================================================================
+// The lag model from end to end: arrival times read off response curves
+// (lagFromCurve()), the line fitted to them (fitServoLag()), refitting curves
+// saved as calibrate-crow prints them, and the keyframe lead the crow then
+// applies (getLeadKeyframeTime()).
+#include "crow-host.h"
+#include <Servo.h>
+#include "settings.h"
+#include "animations.h"
+#include "servo-lag.h"
+#include "servo-lag-csv.h"
+
+Servo beakServo;
+
+// a servo that sits still for deadMs, then moves at a steady rate
+static void modelCurve(uint16_t* samples, uint16_t n, int from, int to, uint16_t deadMs, uint16_t moveMs) {
+  for (uint16_t t = 0; t < n; t++) {
+    if (t <= deadMs) samples[t] = from;
+    else if (t >= deadMs + moveMs) samples[t] = to;
+    else samples[t] = from + (long)(to - from) * (t - deadMs) / moveMs;
+  }
+}
+
+static void testLagFromCurve() {
+  uint16_t curve[LAG_TIMEOUT_MS];
+
+  // arrives when LAG_ARRIVAL_PCT (90%) of the move is covered
+  modelCurve(curve, LAG_TIMEOUT_MS, 1000, 2000, 20, 100);
+  CHECK_EQ(lagFromCurve(curve, LAG_TIMEOUT_MS, 1000, 2000), 20 + 90);
+
+  // closing moves count down
+  modelCurve(curve, LAG_TIMEOUT_MS, 2000, 1000, 20, 100);
+  CHECK_EQ(lagFromCurve(curve, LAG_TIMEOUT_MS, 2000, 1000), 20 + 90);
+
+  // never gets there within the samples
+  modelCurve(curve, LAG_TIMEOUT_MS, 1000, 2000, 250, 100);
+  CHECK_EQ(lagFromCurve(curve, LAG_TIMEOUT_MS, 1000, 2000), -1);
+
+  // a move smaller than LAG_MIN_SPAN is not timed
+  modelCurve(curve, LAG_TIMEOUT_MS, 1000, 1000 + LAG_MIN_SPAN - 1, 0, 10);
+  CHECK_EQ(lagFromCurve(curve, LAG_TIMEOUT_MS, 1000, 1000 + LAG_MIN_SPAN - 1), -1);
+
+  // already there on the first sample
+  modelCurve(curve, LAG_TIMEOUT_MS, 2000, 2000, 0, 1);
+  CHECK_EQ(lagFromCurve(curve, LAG_TIMEOUT_MS, 1000, 2000), 0);
+}
+
+static void testFit() {
+  uint16_t base, travel;
+
+  // an exact line
+  const uint8_t tr[] = {20, 40, 60, 80, 100};
+  const uint16_t lag[] = {30, 40, 50, 60, 70};
+  CHECK(fitServoLag(tr, lag, 5, base, travel));
+  CHECK_EQ(base, 20);
+  CHECK_EQ(travel, 50);
+
+  // scattered repeats round to the nearest ms
+  const uint8_t tr2[] = {20, 20, 100, 100};
+  const uint16_t lag2[] = {29, 31, 69, 72};
+  CHECK(fitServoLag(tr2, lag2, 4, base, travel));
+  CHECK_EQ(base, 20);
+  CHECK_EQ(travel, 51);
+
+  // a lag that shrinks with travel, or a negative base, clamps to 0
+  const uint16_t lag3[] = {70, 60, 50, 40, 30};
+  CHECK(fitServoLag(tr, lag3, 5, base, travel));
+  CHECK_EQ(travel, 0);
+  const uint16_t lag4[] = {0, 10, 20, 30, 40};
+  CHECK(fitServoLag(tr, lag4, 5, base, travel));
+  CHECK_EQ(base, 0);
+  CHECK_EQ(travel, 50);
+
+  // too few moves, or all the same travel
+  CHECK(!fitServoLag(tr, lag, 1, base, travel));
+  const uint8_t same[] = {40, 40, 40};
+  CHECK(!fitServoLag(same, lag, 3, base, travel));
+}
+
+// writes moves the way timeServoMove() prints them (with the log around them)
+static void writeCurves(FILE* f, uint16_t baseMs, uint16_t travelMs) {
+  fprintf(f, "lag,travel,ms,adc\n");
+  for (uint8_t step = 1; step <= LAG_TRAVEL_STEPS; step++) {
+    uint8_t travel = step * 100 / LAG_TRAVEL_STEPS;
+    int from = 900, to = 900 + travel * 20;
+    // 90% of the move lands at base + travelMs * travel / 100
+    uint16_t moveMs = travel;
+    uint16_t deadMs = baseMs + travelMs * travel / 100 - moveMs * LAG_ARRIVAL_PCT / 100;
+    uint16_t curve[LAG_TIMEOUT_MS];
+    modelCurve(curve, LAG_TIMEOUT_MS, from, to, deadMs, moveMs);
+    fprintf(f, "lagspan,%u,%d,%d\n", travel, from, to);
+    for (uint16_t t = 0; t < LAG_TIMEOUT_MS; t++) fprintf(f, "lag,%u,%u,%u\n", travel, t, curve[t]);
+    fprintf(f, "# travel %u%%: %ums\n", travel, lagFromCurve(curve, LAG_TIMEOUT_MS, from, to));
+  }
+  // a move that never arrived is listed but left out of the fit
+  fprintf(f, "lagspan,50,900,1900\n");
+  for (uint16_t t = 0; t < LAG_TIMEOUT_MS; t++) fprintf(f, "lag,50,%u,900\n", t);
+  fprintf(f, "Lag: beak leads by 0ms + 0ms per full move\n");
+}
+
+static void testSavedCurves() {
+  FILE* f = tmpfile();
+  writeCurves(f, 25, 80);
+  rewind(f);
+  LagCsvFit fit;
+  CHECK(lagCsvRead(f, fit));
+  fclose(f);
+  CHECK_EQ(fit.moves.size(), LAG_TRAVEL_STEPS + 1);
+  CHECK_EQ(fit.moves.back().lag, -1);
+  CHECK_EQ(fit.moves[0].samples.size(), LAG_TIMEOUT_MS);
+  CHECK_NEAR(fit.baseMs, 25, 1);
+  CHECK_NEAR(fit.travelMs, 80, 1);
+
+  // nothing to fit
+  f = tmpfile();
+  fprintf(f, "lagspan,40,900,1700\nlag,40,0,900\n");
+  rewind(f);
+  LagCsvFit none;
+  CHECK(!lagCsvRead(f, none));
+  fclose(f);
+  CHECK_EQ(none.moves.size(), 1);
+}
+
+static void testLeadKeyframes() {
+  static const AnimKeyFrame frames[] = {{0, 0}, {100, 50}, {120, 100}, {300, 100}, {400, 0}, {401, 60}};
+  currentAnimation = frames;
+
+  // no lag model: keyframes keep their times
+  setServoLag(0, 0);
+  for (uint8_t i = 0; i < 6; i++) CHECK_EQ(getLeadKeyframeTime(i), frames[i].timeMs);
+
+  setServoLag(10, 40);
+  CHECK_EQ(getLeadKeyframeTime(0), 0);        // the first keyframe is never led
+  CHECK_EQ(getLeadKeyframeTime(1), 100 - 30); // 50% travel: 10 + 20
+  CHECK_EQ(getLeadKeyframeTime(2), 100);      // lead of 30 in a 20ms segment: clamped to the previous keyframe
+  CHECK_EQ(getLeadKeyframeTime(3), 300);      // a hold (zero travel) has no lag
+  CHECK_EQ(getLeadKeyframeTime(4), 400 - 50); // full travel: 10 + 40
+  CHECK_EQ(getLeadKeyframeTime(5), 400);      // 1ms segment: clamped
+  CHECK_EQ(servoLagMs(0), 0);
+  CHECK_EQ(servoLagMs(100), 50);
+
+  // led keyframes stay in order
+  for (uint8_t i = 1; i < 6; i++) CHECK(getLeadKeyframeTime(i) >= getLeadKeyframeTime(i - 1));
+  setServoLag(SERVO_LAG_BASE_MS, SERVO_LAG_TRAVEL_MS);
+}
+
+int main() {
+  testLagFromCurve();
+  testFit();
+  testSavedCurves();
+  testLeadKeyframes();
+  return hostReport("test-servo-lag");
+}
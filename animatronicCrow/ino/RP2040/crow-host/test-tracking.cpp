@@ -0,0 +1,217 @@
+// ============================================================================
+// DIRECTIONAL TRACKING TESTS
+// ============================================================================
+// Plays sensor traces through tracking.h's interrupts on the simulated clock
+// and checks what trackUpdate() makes of them: crossings both ways, a visitor
+// seen by one sensor only, a PIR retriggering, edges just inside and just
+// outside TRACK_WINDOW_MS, and both edges arriving between two passes.
+#include "crow-host.h"
+#include "settings.h"
+#include "tracking.h"
+
+AccelStepper stepper;
+
+static const uint8_t trackPins[2] = {PIN_MOTION_SENSOR, PIN_MOTION_SENSOR2};
+
+static void reset() {
+  hostReset();
+  hostAdvance(10000000);
+  memset((void*)trackEdgeCount, 0, sizeof(trackEdgeCount));
+  memset(trackSeen, 0, sizeof(trackSeen));
+  memset(trackHaveEdge, 0, sizeof(trackHaveEdge));
+  memset(trackPaired, 0, sizeof(trackPaired));
+  trackValid = false;
+  trackArrivals = 0;
+  trackCrossings = 0;
+  pinMode(PIN_MOTION_SENSOR, INPUT);
+  hostSetPin(PIN_MOTION_SENSOR, LOW);
+  hostSetPin(PIN_MOTION_SENSOR2, LOW);
+  trackBegin();
+}
+
+// a sensor output going high (or low) after waitUs, as its interrupt sees it
+static void rise(uint8_t sensor, uint64_t waitUs = 0) {
+  hostAdvance(waitUs);
+  hostSetPin(trackPins[sensor], HIGH);
+}
+
+static void fall(uint8_t sensor, uint64_t waitUs = 0) {
+  hostAdvance(waitUs);
+  hostSetPin(trackPins[sensor], LOW);
+}
+
+// one pass of the crow's loop
+static bool update() {
+  return trackUpdate(millis());
+}
+
+static void testEstimate() {
+  TrackEstimate e = trackEstimate(0, 0);
+  CHECK_EQ(e.side, TRACK_SENSOR1_SIDE);
+  CHECK(!e.crossing);
+  CHECK_EQ(e.speedPercent, 0);
+  CHECK_EQ(e.aimPercent, TRACK_AIM_PERCENT);
+
+  e = trackEstimate(1, TRACK_FAST_MS);
+  CHECK_EQ(e.side, -TRACK_SENSOR1_SIDE);
+  CHECK(e.crossing);
+  CHECK_EQ(e.speedPercent, 100);
+  CHECK_EQ(e.aimPercent, min(TRACK_AIM_PERCENT + TRACK_LEAD_PERCENT, 100));
+  CHECK_EQ(trackEstimate(1, 1).speedPercent, 100);
+
+  // linear between TRACK_FAST_MS and TRACK_SLOW_MS, standing still after
+  e = trackEstimate(0, (TRACK_FAST_MS + TRACK_SLOW_MS) / 2);
+  CHECK_EQ(e.speedPercent, 50);
+  CHECK_EQ(e.aimPercent, TRACK_AIM_PERCENT + TRACK_LEAD_PERCENT / 2);
+  CHECK_EQ(trackEstimate(0, TRACK_SLOW_MS).speedPercent, 0);
+  CHECK_EQ(trackEstimate(0, TRACK_WINDOW_MS).speedPercent, 0);
+  CHECK(trackEstimate(0, TRACK_WINDOW_MS).crossing);
+}
+
+static void testCrossings() {
+  // SENSOR1 then SENSOR2: an arrival on SENSOR1's side, then a crossing
+  // toward SENSOR2's
+  reset();
+  rise(0);
+  CHECK(update());
+  CHECK(!trackLast.crossing);
+  CHECK_EQ(trackLast.side, TRACK_SENSOR1_SIDE);
+  CHECK(!update()); // nothing new
+  rise(1, 700000);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  CHECK_EQ(trackLast.side, -TRACK_SENSOR1_SIDE);
+  CHECK_EQ(trackLast.speedPercent, trackEstimate(1, 700).speedPercent);
+  CHECK_EQ(trackArrivals, 1);
+  CHECK_EQ(trackCrossings, 1);
+
+  // and back the other way, once both sensors have cleared
+  fall(0, 3000000);
+  fall(1);
+  rise(1, TRACK_WINDOW_MS * 1000UL);
+  CHECK(update());
+  CHECK(!trackLast.crossing);
+  rise(0, 250000);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  CHECK_EQ(trackLast.side, TRACK_SENSOR1_SIDE);
+  CHECK_EQ(trackLast.speedPercent, 100);
+  CHECK_EQ(trackCrossings, 2);
+  CHECK(trackFresh(millis()));
+  CHECK(!trackFresh(millis() + TRACK_WINDOW_MS));
+}
+
+static void testSingleSensor() {
+  // a visitor who stays on SENSOR2's side: arrivals only, whatever the timing
+  reset();
+  rise(1);
+  CHECK(update());
+  CHECK(!trackLast.crossing);
+  CHECK_EQ(trackLast.side, -TRACK_SENSOR1_SIDE);
+  fall(1, 2500000);
+  CHECK(!update()); // falling edges are not visitors
+  rise(1, 400000);
+  CHECK(update());
+  CHECK(!trackLast.crossing);
+  CHECK_EQ(trackArrivals, 2);
+  CHECK_EQ(trackCrossings, 0);
+}
+
+static void testRetrigger() {
+  // SENSOR1's PIR retriggers after a crossing toward SENSOR2: its edge was
+  // already used, so this is a new arrival, not a crossing back
+  reset();
+  rise(0);
+  update();
+  rise(1, 500000);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  fall(0, 200000);
+  rise(0, 300000);
+  CHECK(update());
+  CHECK(!trackLast.crossing);
+  CHECK_EQ(trackLast.side, TRACK_SENSOR1_SIDE);
+
+  // that new SENSOR1 edge is unpaired, so SENSOR2 firing again within the
+  // window reads as another crossing toward SENSOR2
+  fall(1, 100000);
+  rise(1, 100000);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  CHECK_EQ(trackLast.side, -TRACK_SENSOR1_SIDE);
+  CHECK_EQ(trackCrossings, 2);
+
+  // a retrigger on the same sensor with nothing on the other in between
+  fall(1, 100000);
+  rise(1, 100000);
+  CHECK(update());
+  CHECK(!trackLast.crossing);
+  CHECK_EQ(trackCrossings, 2);
+  CHECK_EQ(trackArrivals, 3);
+}
+
+static void testWindowEdges() {
+  // the second edge exactly TRACK_WINDOW_MS after the first is a crossing
+  reset();
+  rise(0);
+  update();
+  rise(1, TRACK_WINDOW_MS * 1000UL);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  CHECK_EQ(trackLast.speedPercent, 0);
+
+  // one microsecond later it is an arrival
+  reset();
+  rise(0);
+  update();
+  rise(1, TRACK_WINDOW_MS * 1000UL + 1);
+  CHECK(update());
+  CHECK(!trackLast.crossing);
+  CHECK_EQ(trackCrossings, 0);
+  CHECK_EQ(trackArrivals, 2);
+
+  // and the late SENSOR2 edge can still pair with a SENSOR1 edge after it
+  fall(0, 10000);
+  rise(0, 10000);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  CHECK_EQ(trackLast.side, TRACK_SENSOR1_SIDE);
+}
+
+static void testSamePass() {
+  // both edges land between two passes: taken in the order they happened
+  reset();
+  rise(1);
+  rise(0, 400000);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  CHECK_EQ(trackLast.side, TRACK_SENSOR1_SIDE);
+  CHECK_EQ(trackArrivals, 1);
+  CHECK_EQ(trackCrossings, 1);
+
+  reset();
+  rise(0);
+  rise(1, 400000);
+  CHECK(update());
+  CHECK(trackLast.crossing);
+  CHECK_EQ(trackLast.side, -TRACK_SENSOR1_SIDE);
+
+  // the decision time runs from the edge it was made for
+  hostAdvance(3000);
+  fall(0);
+  fall(1);
+  rise(0, 3000000);
+  hostAdvance(1500);
+  update();
+  CHECK_EQ(trackDecisionUs, 1500);
+}
+
+int main() {
+  testEstimate();
+  testCrossings();
+  testSingleSensor();
+  testRetrigger();
+  testWindowEdges();
+  testSamePass();
+  return hostReport("test-tracking");
+}
@@ -3,11 +3,14 @@
  * Uses dual-core processing: Core0 for components, Core1 for sensor monitoring
  * - Cycles through Steppers -> Servos -> MP3
  * - Sensor(s) states are reflected in LED(s)
+ * - LOAD_TEST instead runs every enabled channel at once from one cooperative
+ *   loop and ends with a pass/fail line per channel plus a JSON summary
  */
 #include <Arduino.h>
 #include <AccelStepper.h>
 #include <DFRobotDFPlayerMini.h>
 #include <Servo.h>
+#include <pico/unique_id.h>
 
 // ============================================================================
 // CONFIGURATION - Enable/Disable Components Here
@@ -24,6 +27,20 @@
 #define ENABLE_SERVO2          false   // Servo on GP3
 #define ENABLE_SERVO3          false   // Servo on GP4
 
+// Load test (bring-up screening)
+#define LOAD_TEST              false   // true: all channels at once with pass/fail report, false: cycle
+#define LOAD_TEST_MS           5000    // Duration of the load test
+#define STEPPER_TEST_SPEED     2000    // Constant step rate (steps/second)
+#define STEPPER_RATE_TOL_PCT   1       // Allowed step-rate error (percent)
+#define SERVO_SWEEP_MS         4000    // Full min-max-min sweep period (slow enough to track)
+#define SERVO_PWM_TOL_US       25      // Allowed pulse width error (includes one frame of sweep)
+#define SERVO_PERIOD_US        20000   // Expected servo frame period
+#define SERVO_PERIOD_TOL_US    200     // Allowed frame period error
+#define LED_TEST_BLINK_MS      250     // LED toggle interval
+#define MP3_QUERY_MS           250     // DFPlayer volume query interval
+#define MP3_QUERY_TIMEOUT_MS   500     // Query counts as lost after this
+#define MP3_LATENCY_LIMIT_MS   100     // Allowed query response time
+
 // Test settings
 #define STEPPER_TEST_STEPS     400     // Steps per test cycle
 #define MP3_VOLUME             10      // Volume range 0-30
@@ -75,6 +92,11 @@ Servo servo1, servo2, servo3;
 // Sensor state tracking (shared between cores)
 volatile bool sensor1State = false;
 volatile bool sensor2State = false;
+volatile unsigned long sensor1Edges = 0;
+volatile unsigned long sensor2Edges = 0;
+volatile bool loadTestRunning = false;
+
+bool dfPlayerReady = false;
 
 // ============================================================================
 // RGB LED COLORS (only defined if NeoPixel enabled)
@@ -85,6 +107,8 @@ uint32_t COLOR_STEPPER = rgbLED.Color(0, 0, 50);     // Blue
 uint32_t COLOR_SERVO = rgbLED.Color(50, 25, 0);      // Orange
 uint32_t COLOR_MP3 = rgbLED.Color(50, 0, 50);        // Purple
 uint32_t COLOR_ERROR = rgbLED.Color(50, 0, 0);       // Red
+uint32_t COLOR_LOAD = rgbLED.Color(0, 40, 40);       // Cyan
+uint32_t COLOR_PASS = rgbLED.Color(0, 50, 0);        // Green
 #endif
 
 // ============================================================================
@@ -140,6 +164,7 @@ void setup() {
     Serial1.begin(9600);
 
     if (dfPlayer.begin(Serial1)) {
+      dfPlayerReady = true;
       dfPlayer.volume(MP3_VOLUME);
       int trackCount = dfPlayer.readFileCounts();
       Serial.print("[✓] DFPlayer Mini initialized with ");
@@ -215,26 +240,29 @@ void loop1() {
   static bool lastSensor1 = false;
   static bool lastSensor2 = false;
 
+  // LEDs belong to Core0 while the load test runs
   if (ENABLE_SENSOR1) {
     sensor1State = digitalRead(SENSOR1_PIN);
-    if (ENABLE_LED1) {
+    if (ENABLE_LED1 && !loadTestRunning) {
       digitalWrite(LED1_PIN, sensor1State);
     }
 
     if (sensor1State != lastSensor1) {
       lastSensor1 = sensor1State;
+      sensor1Edges++;
       // Note: Serial from Core1 can be unreliable, but state is tracked
     }
   }
 
   if (ENABLE_SENSOR2) {
     sensor2State = digitalRead(SENSOR2_PIN);
-    if (ENABLE_LED2) {
+    if (ENABLE_LED2 && !loadTestRunning) {
       digitalWrite(LED2_PIN, sensor2State);
     }
 
     if (sensor2State != lastSensor2) {
       lastSensor2 = sensor2State;
+      sensor2Edges++;
     }
   }
 
@@ -326,26 +354,403 @@ void testMP3() {
   Serial.println("MP3 test completed.");
 }
 
+// ============================================================================
+// LOAD TEST - all channels at once
+// ============================================================================
+// One cooperative loop services every channel: each update does a slice of
+// work and returns, so the steppers run between every slice. Servo pulses are
+// timed by pin-change interrupts on the servo pins (the pad still reads back
+// while the PIO drives it), LEDs are read back after each write, and the
+// DFPlayer is queried directly on Serial1 to time its replies.
+
+#define MP3_FRAME_LEN          10
+#define MP3_CMD_NEXT           0x01
+#define MP3_CMD_STOP           0x16
+#define MP3_CMD_QUERY_VOLUME   0x43
+#define MAX_RESULTS            10
+
+struct PwmCapture {
+  volatile int commandUs;
+  volatile unsigned long riseUs;
+  volatile unsigned long pulses;
+  volatile unsigned long maxWidthErrUs;
+  volatile unsigned long maxPeriodErrUs;
+};
+
+struct ChannelResult {
+  const char* name;
+  bool pass;
+  float value;
+  float limit;
+  const char* unit;
+};
+
+Servo* const servos[3] = {&servo1, &servo2, &servo3};
+const bool servoEnabled[3] = {ENABLE_SERVO1, ENABLE_SERVO2, ENABLE_SERVO3};
+const uint8_t servoPins[3] = {SERVO1_PIN, SERVO2_PIN, SERVO3_PIN};
+const int servoMin[3] = {SERVO1_PWM_MIN, SERVO2_PWM_MIN, SERVO3_PWM_MIN};
+const int servoMax[3] = {SERVO1_PWM_MAX, SERVO2_PWM_MAX, SERVO3_PWM_MAX};
+PwmCapture pwmCapture[3];
+
+const bool ledEnabled[2] = {ENABLE_LED1, ENABLE_LED2};
+const uint8_t ledPins[2] = {LED1_PIN, LED2_PIN};
+bool ledLevel[2];
+unsigned long ledToggles[2];
+unsigned long ledMismatches[2];
+
+uint8_t mp3Rx[MP3_FRAME_LEN];
+uint8_t mp3RxLen = 0;
+bool mp3QueryPending = false;
+unsigned long mp3QuerySentUs = 0;
+unsigned long mp3LastQueryUs = 0;
+unsigned long mp3Queries = 0;
+unsigned long mp3Replies = 0;
+unsigned long mp3Timeouts = 0;
+unsigned long mp3LatencyMaxUs = 0;
+unsigned long mp3LatencyTotalUs = 0;
+
+unsigned long loadLoops = 0;
+unsigned long loadLoopMaxUs = 0;
+
+ChannelResult results[MAX_RESULTS];
+uint8_t resultCount = 0;
+
+// Servo pulse capture (interrupt context)
+void capturePwmEdge(uint8_t idx) {
+  PwmCapture& c = pwmCapture[idx];
+  unsigned long now = micros();
+  if (digitalRead(servoPins[idx])) {
+    if (c.riseUs != 0 && c.pulses > 1) {
+      unsigned long err = labs((long)(now - c.riseUs) - SERVO_PERIOD_US);
+      if (err > c.maxPeriodErrUs) c.maxPeriodErrUs = err;
+    }
+    c.riseUs = now;
+  } else if (c.riseUs != 0) {
+    unsigned long err = labs((long)(now - c.riseUs) - c.commandUs);
+    if (c.pulses > 1 && err > c.maxWidthErrUs) c.maxWidthErrUs = err; // first pulse may be partial
+    c.pulses++;
+  }
+}
+
+void capturePwm1() { capturePwmEdge(0); }
+void capturePwm2() { capturePwmEdge(1); }
+void capturePwm3() { capturePwmEdge(2); }
+
+// triangle sweep between each servo's limits, one write per frame
+void updateServoLoad(unsigned long now) {
+  static unsigned long lastUpdate = 0;
+  if (now - lastUpdate < SERVO_PERIOD_US / 1000) return;
+  lastUpdate = now;
+
+  unsigned long half = SERVO_SWEEP_MS / 2;
+  unsigned long phase = now % SERVO_SWEEP_MS;
+  unsigned long ramp = phase < half ? phase : SERVO_SWEEP_MS - phase;
+  for (uint8_t i = 0; i < 3; i++) {
+    if (!servoEnabled[i]) continue;
+    int us = servoMin[i] + (long)(servoMax[i] - servoMin[i]) * ramp / half;
+    pwmCapture[i].commandUs = us;
+    servos[i]->writeMicroseconds(us);
+  }
+}
+
+// toggle and read back each LED
+void updateLedLoad(unsigned long now) {
+  static unsigned long lastToggle = 0;
+  if (now - lastToggle < LED_TEST_BLINK_MS) return;
+  lastToggle = now;
+
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!ledEnabled[i]) continue;
+    ledLevel[i] = !ledLevel[i];
+    digitalWrite(ledPins[i], ledLevel[i]);
+    ledToggles[i]++;
+    if (digitalRead(ledPins[i]) != ledLevel[i]) ledMismatches[i]++;
+  }
+}
+
+// raw DFPlayer command without ACK (the library would block waiting for one)
+void sendMp3Command(uint8_t cmd, uint16_t arg) {
+  uint8_t frame[MP3_FRAME_LEN] = {0x7E, 0xFF, 0x06, cmd, 0x00, (uint8_t)(arg >> 8), (uint8_t)arg, 0, 0, 0xEF};
+  uint16_t sum = 0;
+  for (uint8_t i = 1; i < 7; i++) sum += frame[i];
+  uint16_t checksum = 0 - sum;
+  frame[7] = checksum >> 8;
+  frame[8] = checksum & 0xFF;
+  Serial1.write(frame, MP3_FRAME_LEN);
+}
+
+// query the volume on a fixed interval and time the reply
+void updateMp3Load(unsigned long nowUs) {
+  while (Serial1.available() > 0) {
+    uint8_t b = Serial1.read();
+    if (mp3RxLen == 0 && b != 0x7E) continue; // resync
+    mp3Rx[mp3RxLen++] = b;
+    if (mp3RxLen < MP3_FRAME_LEN) continue;
+
+    mp3RxLen = 0;
+    uint16_t sum = 0;
+    for (uint8_t i = 1; i < 7; i++) sum += mp3Rx[i];
+    uint16_t checksum = (mp3Rx[7] << 8) | mp3Rx[8];
+    if (mp3Rx[9] != 0xEF || (uint16_t)(sum + checksum) != 0) continue;
+    if (mp3Rx[3] == MP3_CMD_QUERY_VOLUME && mp3QueryPending) {
+      unsigned long latency = nowUs - mp3QuerySentUs;
+      mp3QueryPending = false;
+      mp3Replies++;
+      mp3LatencyTotalUs += latency;
+      if (latency > mp3LatencyMaxUs) mp3LatencyMaxUs = latency;
+    }
+  }
+
+  if (mp3QueryPending && nowUs - mp3QuerySentUs >= MP3_QUERY_TIMEOUT_MS * 1000UL) {
+    mp3QueryPending = false;
+    mp3Timeouts++;
+  }
+  if (!mp3QueryPending && nowUs - mp3LastQueryUs >= MP3_QUERY_MS * 1000UL) {
+    sendMp3Command(MP3_CMD_QUERY_VOLUME, 0);
+    mp3QueryPending = true;
+    mp3QuerySentUs = nowUs;
+    mp3LastQueryUs = nowUs;
+    mp3Queries++;
+  }
+}
+
+void addResult(const char* name, bool pass, float value, float limit, const char* unit) {
+  if (resultCount >= MAX_RESULTS) return;
+  results[resultCount++] = {name, pass, value, limit, unit};
+  Serial.print(pass ? "[✓] " : "[✗] ");
+}
+
+void runLoadTest() {
+  #if ENABLE_NEOPIXEL_STATUS
+  rgbLED.setPixelColor(0, COLOR_LOAD);
+  rgbLED.show();
+  #endif
+  Serial.println("\n--- Load Test ---");
+  Serial.print("All channels for ");
+  Serial.print(LOAD_TEST_MS);
+  Serial.println("ms...");
+
+  // reset counters
+  memset((void*)pwmCapture, 0, sizeof(pwmCapture));
+  memset(ledToggles, 0, sizeof(ledToggles));
+  memset(ledMismatches, 0, sizeof(ledMismatches));
+  mp3RxLen = 0;
+  mp3QueryPending = false;
+  mp3Queries = mp3Replies = mp3Timeouts = 0;
+  mp3LatencyMaxUs = mp3LatencyTotalUs = 0;
+  loadLoops = loadLoopMaxUs = 0;
+  resultCount = 0;
+
+  if (ENABLE_SERVO1) attachInterrupt(digitalPinToInterrupt(SERVO1_PIN), capturePwm1, CHANGE);
+  if (ENABLE_SERVO2) attachInterrupt(digitalPinToInterrupt(SERVO2_PIN), capturePwm2, CHANGE);
+  if (ENABLE_SERVO3) attachInterrupt(digitalPinToInterrupt(SERVO3_PIN), capturePwm3, CHANGE);
+
+  if (ENABLE_STEPPER1) {
+    stepper1.enableOutputs();
+    stepper1.setCurrentPosition(0);
+    stepper1.setMaxSpeed(STEPPER_TEST_SPEED);
+    stepper1.setSpeed(STEPPER_TEST_SPEED);
+  }
+  if (ENABLE_STEPPER2) {
+    stepper2.enableOutputs();
+    stepper2.setCurrentPosition(0);
+    stepper2.setMaxSpeed(STEPPER_TEST_SPEED);
+    stepper2.setSpeed(STEPPER_TEST_SPEED);
+  }
+
+  if (dfPlayerReady) {
+    while (Serial1.available() > 0) Serial1.read();
+    sendMp3Command(MP3_CMD_NEXT, 0); // audio playing is part of the load
+  }
+
+  // cooperative scheduler: no Serial output until it ends
+  loadTestRunning = true;
+  unsigned long startUs = micros();
+  unsigned long lastUs = startUs;
+  mp3LastQueryUs = startUs;
+  while (micros() - startUs < LOAD_TEST_MS * 1000UL) {
+    if (ENABLE_STEPPER1) stepper1.runSpeed();
+    if (ENABLE_STEPPER2) stepper2.runSpeed();
+    unsigned long now = millis();
+    updateServoLoad(now);
+    updateLedLoad(now);
+    if (dfPlayerReady) updateMp3Load(micros());
+
+    unsigned long nowUs = micros();
+    if (nowUs - lastUs > loadLoopMaxUs) loadLoopMaxUs = nowUs - lastUs;
+    lastUs = nowUs;
+    loadLoops++;
+  }
+  unsigned long elapsedUs = micros() - startUs;
+  loadTestRunning = false;
+
+  // stop everything
+  if (ENABLE_SERVO1) detachInterrupt(digitalPinToInterrupt(SERVO1_PIN));
+  if (ENABLE_SERVO2) detachInterrupt(digitalPinToInterrupt(SERVO2_PIN));
+  if (ENABLE_SERVO3) detachInterrupt(digitalPinToInterrupt(SERVO3_PIN));
+  for (uint8_t i = 0; i < 3; i++) {
+    if (servoEnabled[i]) servos[i]->write(90);
+  }
+  if (ENABLE_STEPPER1) stepper1.disableOutputs();
+  if (ENABLE_STEPPER2) stepper2.disableOutputs();
+  if (dfPlayerReady) sendMp3Command(MP3_CMD_STOP, 0);
+  for (uint8_t i = 0; i < 2; i++) {
+    if (ledEnabled[i]) digitalWrite(ledPins[i], LOW);
+  }
+
+  reportLoadTest(elapsedUs);
+}
+
+// ----------------------------------------------------------------------------
+// Report: one line per channel, then a single JSON summary line
+// ----------------------------------------------------------------------------
+void reportStepper(const char* name, AccelStepper& stepper, unsigned long elapsedUs) {
+  float expected = (float)STEPPER_TEST_SPEED * elapsedUs / 1000000.0;
+  long steps = stepper.currentPosition();
+  float errorPct = fabs(steps - expected) * 100.0 / expected;
+  addResult(name, errorPct <= STEPPER_RATE_TOL_PCT, errorPct, STEPPER_RATE_TOL_PCT, "pct");
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(steps);
+  Serial.print(" of ");
+  Serial.print(expected, 0);
+  Serial.print(" steps (");
+  Serial.print(errorPct, 2);
+  Serial.println("% error)");
+}
+
+void reportLoadTest(unsigned long elapsedUs) {
+  Serial.println("\n--- Load Test Results ---");
+
+  if (ENABLE_STEPPER1) reportStepper("stepper1", stepper1, elapsedUs);
+  if (ENABLE_STEPPER2) reportStepper("stepper2", stepper2, elapsedUs);
+
+  static const char* servoNames[3] = {"servo1", "servo2", "servo3"};
+  unsigned long expectedPulses = elapsedUs / SERVO_PERIOD_US;
+  for (uint8_t i = 0; i < 3; i++) {
+    if (!servoEnabled[i]) continue;
+    PwmCapture& c = pwmCapture[i];
+    bool pass = c.pulses >= expectedPulses * 9 / 10 &&
+                c.maxWidthErrUs <= SERVO_PWM_TOL_US &&
+                c.maxPeriodErrUs <= SERVO_PERIOD_TOL_US;
+    addResult(servoNames[i], pass, c.maxWidthErrUs, SERVO_PWM_TOL_US, "us");
+    Serial.print(servoNames[i]);
+    Serial.print(": ");
+    Serial.print(c.pulses);
+    Serial.print(" of ");
+    Serial.print(expectedPulses);
+    Serial.print(" pulses, width error ");
+    Serial.print(c.maxWidthErrUs);
+    Serial.print("us, period error ");
+    Serial.print(c.maxPeriodErrUs);
+    Serial.println("us (max)");
+  }
+
+  static const char* ledNames[2] = {"led1", "led2"};
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!ledEnabled[i]) continue;
+    addResult(ledNames[i], ledToggles[i] > 0 && ledMismatches[i] == 0, ledMismatches[i], 0, "mismatches");
+    Serial.print(ledNames[i]);
+    Serial.print(": ");
+    Serial.print(ledMismatches[i]);
+    Serial.print(" read-back mismatches in ");
+    Serial.print(ledToggles[i]);
+    Serial.println(" toggles");
+  }
+
+  if (ENABLE_DFPLAYER) {
+    float latencyMs = mp3LatencyMaxUs / 1000.0;
+    bool pass = dfPlayerReady && mp3Replies > 0 && mp3Timeouts == 0 && latencyMs <= MP3_LATENCY_LIMIT_MS;
+    addResult("dfplayer", pass, latencyMs, MP3_LATENCY_LIMIT_MS, "ms");
+    Serial.print("dfplayer: ");
+    if (!dfPlayerReady) {
+      Serial.println("not initialized");
+    } else {
+      Serial.print(mp3Replies);
+      Serial.print(" of ");
+      Serial.print(mp3Queries);
+      Serial.print(" replies, ");
+      Serial.print(mp3Timeouts);
+      Serial.print(" timeouts, latency ");
+      Serial.print(mp3Replies ? mp3LatencyTotalUs / mp3Replies / 1000.0 : 0.0, 1);
+      Serial.print("ms (max ");
+      Serial.print(latencyMs, 1);
+      Serial.println("ms)");
+    }
+  }
+
+  // a loop slower than one step interval costs step-rate accuracy
+  unsigned long loopLimitUs = 1000000UL / STEPPER_TEST_SPEED;
+  addResult("loop", loadLoopMaxUs <= loopLimitUs, loadLoopMaxUs, loopLimitUs, "us");
+  Serial.print("loop: ");
+  Serial.print(loadLoops);
+  Serial.print(" passes, max ");
+  Serial.print(loadLoopMaxUs);
+  Serial.println("us");
+
+  // sensors need a person in front of them, so they are reported but not graded
+  if (ENABLE_SENSOR1) {
+    Serial.print("[•] sensor1: ");
+    Serial.print(sensor1Edges);
+    Serial.println(" edges since boot");
+  }
+  if (ENABLE_SENSOR2) {
+    Serial.print("[•] sensor2: ");
+    Serial.print(sensor2Edges);
+    Serial.println(" edges since boot");
+  }
+
+  bool boardPass = true;
+  for (uint8_t i = 0; i < resultCount; i++) {
+    if (!results[i].pass) boardPass = false;
+  }
+
+  char boardId[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+  pico_get_unique_board_id_string(boardId, sizeof(boardId));
+  Serial.print("{\"board\":\"");
+  Serial.print(boardId);
+  Serial.print("\",\"test_ms\":");
+  Serial.print(elapsedUs / 1000);
+  Serial.print(",\"pass\":");
+  Serial.print(boardPass ? "true" : "false");
+  Serial.print(",\"channels\":[");
+  for (uint8_t i = 0; i < resultCount; i++) {
+    if (i > 0) Serial.print(",");
+    Serial.print("{\"ch\":\"");
+    Serial.print(results[i].name);
+    Serial.print("\",\"pass\":");
+    Serial.print(results[i].pass ? "true" : "false");
+    Serial.print(",\"value\":");
+    Serial.print(results[i].value, 2);
+    Serial.print(",\"limit\":");
+    Serial.print(results[i].limit, 2);
+    Serial.print(",\"unit\":\"");
+    Serial.print(results[i].unit);
+    Serial.print("\"}");
+  }
+  Serial.println("]}");
+  Serial.println(boardPass ? "BOARD PASS" : "BOARD FAIL");
+
+  #if ENABLE_NEOPIXEL_STATUS
+  rgbLED.setPixelColor(0, boardPass ? COLOR_PASS : COLOR_ERROR);
+  rgbLED.show();
+  #endif
+}
+
 // ============================================================================
 // MAIN LOOP - Core0
 // ============================================================================
 void loop() {
-  // Display sensor status from Core1
-  static unsigned long lastSensorReport = 0;
-  if (millis() - lastSensorReport > 2000) {
-    if (ENABLE_SENSOR1 || ENABLE_SENSOR2) {
-      Serial.print("[Sensors] ");
-      if (ENABLE_SENSOR1) {
-        Serial.print("S1:");
-        Serial.print(sensor1State ? "HIGH " : "LOW  ");
-      }
-      if (ENABLE_SENSOR2) {
-        Serial.print("S2:");
-        Serial.print(sensor2State ? "HIGH " : "LOW  ");
-      }
-      Serial.println();
+  reportSensors();
+
+  if (LOAD_TEST) {
+    static bool tested = false;
+    if (!tested || (Serial.available() > 0 && tolower(Serial.read()) == 't')) {
+      runLoadTest();
+      tested = true;
+      Serial.println("Send 't' to run the load test again.");
     }
-    lastSensorReport = millis();
+    return;
   }
 
   // Run component tests in sequence
@@ -366,6 +771,26 @@ void loop() {
   Serial.println("========================================");
 }
 
+// Display sensor status from Core1
+void reportSensors() {
+  static unsigned long lastSensorReport = 0;
+  if (millis() - lastSensorReport > 2000) {
+    if (ENABLE_SENSOR1 || ENABLE_SENSOR2) {
+      Serial.print("[Sensors] ");
+      if (ENABLE_SENSOR1) {
+        Serial.print("S1:");
+        Serial.print(sensor1State ? "HIGH " : "LOW  ");
+      }
+      if (ENABLE_SENSOR2) {
+        Serial.print("S2:");
+        Serial.print(sensor2State ? "HIGH " : "LOW  ");
+      }
+      Serial.println();
+    }
+    lastSensorReport = millis();
+  }
+}
+
 void printDFPlayerDetail(uint8_t type, int value){
   switch (type) {
   case TimeOut: